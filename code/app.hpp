@@ -3,34 +3,143 @@
 
 #include <memory>
 #include <map>
+#include <atomic>
 #include <vector>
+#include <array>
+#include <span>
+#include <string>
+#include <optional>
+#include <limits>
+#include <fstream>
 #include <raylib.h>
 #include <raymath.h>
 
+#include "settings.hpp"
 #include "parts/part.hpp"
-#include "parts/waveforms/sine_waveform.hpp"
-#include "parts/waveforms/saw_waveform.hpp"
-#include "parts/synth.hpp"
+#include "parts/voice_bank.hpp"
+#include "parts/resonator_bank.hpp"
+#include "parts/audio_graph.hpp"
+#include "parts/nodes/sum_node.hpp"
+#include "parts/nodes/voice_bank_node.hpp"
+#include "parts/nodes/resonator_bank_node.hpp"
+#include "parts/mixer.hpp"
+#include "parts/recorder.hpp"
+#include "parts/spectrum_analyser.hpp"
+#include "utilities/spsc_queue.hpp"
+#include "utilities/performance_monitor.hpp"
+#include "utilities/scope.hpp"
+#include "utilities/triple_buffer.hpp"
 
 template <class = void>
 class App final : public Part<>
 {
 public:
-    using SynthType = Synth<short>;
-
-    template <class TSampleType, SizeType TSampleCount>
-    using KeyboardWaveformType = SineWaveform<TSampleType, TSampleCount>;
-    using KeyboardType = std::map<KeyboardKey, SynthType>;
-
-    template <class TSampleType, SizeType TSampleCount>
-    using ResonanceChamberWaveformType = SineWaveform<TSampleType, TSampleCount>;
-    using ResonanceChamberType = std::vector<SynthType>;
-    using ResonanceCacheType = std::map<FloatType, FloatType>;
+    using MixerType = Mixer<>;
+    using RecorderType = Recorder<>;
+    using SpectrumAnalyserType = SpectrumAnalyser<>;
+
+    using VoiceBankType = VoiceBank<>;
+    // Each keyboard key plays the note of the same index.
+    using KeyboardType = std::map<KeyboardKey, SizeType>;
+
+    // The sympathetic strings of the resonance chambers, PARTIAL_COUNT modes per chamber.
+    using ResonatorBankType = ResonatorBank<>;
+    using ResonatorModeType = ResonatorBankType::ModeType;
+    // Voices feed the resonators, and both are summed into the block handed to the mixer.
+    using AudioGraphType = AudioGraph<>;
+
+    // UI-thread state of one note; only changes of `amplitude` are sent to the audio thread, which smooths them.
+    struct KeyControlType
+    {
+        BoolType down = false;
+        // Down at some Perform since the last Tick, so a tap that falls between two control steps still plays one.
+        BoolType pressed = false;
+        FloatType amplitude = 0.0;
+        FloatType sentAmplitude = 0.0;
+    };
+    using KeyControlsType = std::vector<KeyControlType>;
+
+    // A note starts on a sounding amplitude and is released by a silent one; BEND multiplies its pitch by `value`.
+    enum class NoteEventKind
+    {
+        AMPLITUDE,
+        BEND,
+    };
+
+    // The only channel from the control side to the audio thread.
+    // `time` counts samples on the audio clock since Start(); the audio thread splits its blocks so that every event
+    // takes effect exactly at its sample, and events that are already due apply before the next rendered sample.
+    struct NoteEventType
+    {
+        SizeType time;
+        NoteEventKind kind;
+        SizeType note;
+        FloatType value;
+    };
+    using NoteEventQueueType = SpscQueue<NoteEventType, 1024>;
+    using TimePointType = PerformanceMonitor::TimePointType;
+
+    // The audio clock as the audio thread last published it: the callback that started at `time` began at `sampleTime`.
+    // `periodSampleCount` is the largest pull so far, 0 until the device has pulled once.
+    struct AudioClockType
+    {
+        SizeType sampleTime;
+        TimePointType time;
+        SizeType periodSampleCount;
+    };
+
+    // Each chamber scope and each key ring is one line strip of `...StripLength` consecutive points.
+    // Scopes zigzag between the minimum and the maximum of every column of the latest Scope frame.
+    struct GeometryType
+    {
+        std::vector<Vector2> chamberPoints;
+        std::vector<Vector2> masterPoints;
+        std::vector<Vector2> keyPoints;
+        std::vector<Vector2> keyMarkers;
+        // The spectrum is one strip; each chamber pitch marker is a pair of points.
+        std::vector<Vector2> spectrumPoints;
+        std::vector<Vector2> spectrumMarkers;
+        SizeType chamberStripLength;
+        SizeType keyStripLength;
+        FloatType centerCircleSize;
+        FloatType keyMarkerSize;
+
+        // Unit directions around the rings, cached until the number of columns per ring changes.
+        std::vector<Vector2> ringDirections;
+        std::vector<Vector2> keyDirections;
+    };
 
     static constexpr const auto ENGRAVING = "Gracile";
+    static constexpr const auto OVERLAY_KEY = KEY_F1;
+    static constexpr const auto PERFORMANCE_EXPORT_KEY = KEY_F2;
+    static constexpr const auto PERFORMANCE_CSV_PATH = "gracile-performance.csv";
+    static constexpr const auto PERFORMANCE_JSON_PATH = "gracile-performance.json";
+    static constexpr const auto RECORD_KEY = KEY_F3;
+    static constexpr const auto RECORDING_PATH = "gracile-recording.wav";
+    static constexpr const auto SPECTRUM_KEY = KEY_F4;
 
     static constexpr const auto AVERAGE_AMPLITUDE = 5000.0;
+    static constexpr const auto MASTER_GAIN = 1.0;
+    static constexpr const SizeType VOICE_CAPACITY = 32;
+    // Event time meaning as soon as possible, used when rendering offline; live input is stamped by EstimateEventTime.
+    static constexpr const SizeType IMMEDIATE = 0;
+    // FindNote accepts frequencies up to this far from a note.
+    static constexpr const auto NOTE_MATCH_CENTS = 50.0;
+    // About two pixels per column in the default 800-pixel window.
+    static constexpr const SizeType SCOPE_COLUMN_COUNT = 400;
+    // The spectrum spans SPECTRUM_MIN_FREQUENCY to the Nyquist frequency on a logarithmic axis, one point per
+    // SPECTRUM_POINT_SPACING pixels, with MIN_DECIBELS at the bottom edge and 0 dB SPECTRUM_HEIGHT_RATIO of the screen above it.
+    static constexpr const auto SPECTRUM_MIN_FREQUENCY = 20.0;
+    static constexpr const IntType SPECTRUM_POINT_SPACING = 2;
+    static constexpr const auto SPECTRUM_HEIGHT_RATIO = 0.3;
+
+    // Loudness follows mouse speed in pixels per frame at the frame rate the mapping was tuned at.
+    static constexpr const auto MOUSE_SPEED_REFERENCE_RATE = 30.0;
+    static constexpr const auto CONTROL_AMPLITUDE_MIN_DIFFERENCE = 0.0005;
     static constexpr const auto RESONANCE_CHAMBER_AMPLITUDE_FACTOR = 0.15;
+    // Seconds for a chamber's fundamental to fall by 60 dB; partial k decays k times faster.
+    static constexpr const auto RESONANCE_DECAY_TIME = 2.5;
+    static constexpr const SizeType PARTIAL_COUNT = 8;
     static constexpr const auto RESONANCE_NEW_PEAK_AMPLITUDE_FACTOR = 0.5;
     static constexpr const auto RESONANCE_ADJECENT_AMPLUTUDE_FACTOR = 0.8;
     static constexpr const auto RESONANCE_MAX_ACCEPTED_INTERVAL_RATIO_DIFFERENCE = 0.01;
@@ -50,19 +159,74 @@ public:
     static constexpr const auto A5 = 880.0;
     static constexpr const auto B5 = 987.8;
 
+    static constexpr const auto KEYBOARD_KEYS = std::array{
+        // 4th Octave.
+        KEY_Z, KEY_X, KEY_C, KEY_V, KEY_B, KEY_N, KEY_M,
+        // 5th Octave.
+        KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U};
+    static constexpr const auto KEYBOARD_FREQUENCIES = std::array{
+        C4, D4, E4, F4, G4, A4, B4,
+        C5, D5, E5, F5, G5, A5, B5};
+    static constexpr const auto CHAMBER_FREQUENCIES = std::array{/* C4, */ D4, E4, /* F4, */ G4, A4 /* , B4 */};
+
+    static constexpr const auto KEY_COUNT = KEYBOARD_KEYS.size();
+    static constexpr const auto CHAMBER_COUNT = CHAMBER_FREQUENCIES.size();
+    static constexpr const auto MODE_COUNT = CHAMBER_COUNT * PARTIAL_COUNT;
+    // Scope channels: one per note, then one per chamber, then the master bus.
+    static constexpr const auto SCOPE_CHAMBER_CHANNEL = KEY_COUNT;
+    static constexpr const auto SCOPE_MASTER_CHANNEL = KEY_COUNT + CHAMBER_COUNT;
+    static constexpr const auto SCOPE_CHANNEL_COUNT = SCOPE_MASTER_CHANNEL + 1;
+    static_assert(KEYBOARD_FREQUENCIES.size() == KEY_COUNT);
+
+    using ResonatorModesType = std::array<ResonatorModeType, MODE_COUNT>;
+
     static constexpr const auto DARK_COLOR = (Color){13, 27, 42, 255};
     static constexpr const auto DARK_GREY_COLOR = (Color){46, 64, 89, 255};
     static constexpr const auto GREY_COLOR = (Color){119, 141, 169, 255};
     static constexpr const auto LIGHT_COLOR = (Color){224, 225, 221, 255};
 
 private:
+    VoiceBankType voices;
     KeyboardType keyboard;
-    ResonanceChamberType chambers;
-    ResonanceCacheType resonances;
+    ResonatorBankType resonators;
+    AudioGraphType graph;
+    KeyControlsType controls;
+    NoteEventQueueType noteEvents;
+    // Audio thread only; the popped event that is not due yet, and the samples rendered since Start().
+    std::optional<NoteEventType> pendingEvent;
+    SizeType sampleTime;
+    SizeType periodSampleCount;
+    TripleBuffer<AudioClockType> audioClock;
+    // UI thread only; the last time EstimateEventTime returned, so stamps never go backwards.
+    SizeType eventTime;
+    // UI thread only; the last control step's time, and the mouse velocity it used and the next frame glides from.
+    SizeType stepTime;
+    FloatType stepMouseVelocity;
+    FloatType frameStartMouseVelocity;
+    MixerType mixer;
+    RecorderType recorder;
+    SpectrumAnalyserType analyser;
+    Scope scope;
+    GeometryType geometry;
+    PerformanceMonitor performance;
+    BoolType overlayVisible;
+
+    static inline std::atomic<App *> instance = nullptr;
+
+    static auto Callback(void *pSamples, unsigned int pSampleCount) -> void
+    {
+        const auto app = instance.load(std::memory_order_acquire);
+        if (app != nullptr)
+            app->Render(pSamples, pSampleCount);
+    }
 
-    static auto computeResonance(FloatType pIntervalRatio) -> FloatType
+public:
+    static constexpr auto ComputeResonance(FloatType pIntervalRatio) -> FloatType
     {
-        const auto targetIntervalRatio = std::abs(pIntervalRatio);
+        constexpr auto absolute = [](FloatType pValue)
+        { return pValue < 0.0 ? -pValue : pValue; };
+
+        const auto targetIntervalRatio = absolute(pIntervalRatio);
         auto intervalRatioSearchDisplacement = 1.0;
         auto intervalRatio = 1.0;
         auto amplitudeFactor = 1.0;
@@ -70,10 +234,10 @@ private:
         while (true)
         {
             const auto intervalRatioDifference = targetIntervalRatio - intervalRatio;
-            const auto absoluteIntervalRatioDifference = std::abs(intervalRatioDifference);
+            const auto absoluteIntervalRatioDifference = absolute(intervalRatioDifference);
             if (absoluteIntervalRatioDifference < RESONANCE_MAX_ACCEPTED_INTERVAL_RATIO_DIFFERENCE)
             {
-                amplitudeFactor = std::lerp(amplitudeFactor, 0.0, absoluteIntervalRatioDifference / RESONANCE_MAX_ACCEPTED_INTERVAL_RATIO_DIFFERENCE);
+                amplitudeFactor *= 1.0 - absoluteIntervalRatioDifference / RESONANCE_MAX_ACCEPTED_INTERVAL_RATIO_DIFFERENCE;
                 break;
             }
 
@@ -89,166 +253,495 @@ private:
                 intervalRatioSearchDisplacement *= 0.5;
                 intervalRatio += -intervalRatioSearchDisplacement;
                 if (intervalRatio > targetIntervalRatio)
-                    intervalRatioSearchDisplacement = std::abs(intervalRatioSearchDisplacement);
+                    intervalRatioSearchDisplacement = absolute(intervalRatioSearchDisplacement);
                 else
-                    intervalRatioSearchDisplacement = -std::abs(intervalRatioSearchDisplacement);
+                    intervalRatioSearchDisplacement = -absolute(intervalRatioSearchDisplacement);
             }
         }
         return amplitudeFactor;
     }
 
+    // Each chamber is a string with harmonic partials; a partial couples to the keyboard as strongly as
+    // ComputeResonance rates its interval to the fundamental, and rings for a shorter time the higher it is.
+    static constexpr auto ComputeResonatorModes(const std::array<FloatType, CHAMBER_COUNT> &pChamberFrequencies) -> ResonatorModesType
+    {
+        auto modes = ResonatorModesType();
+        for (SizeType chamberIndex = 0; chamberIndex < CHAMBER_COUNT; chamberIndex++)
+            for (SizeType partial = 1; partial <= PARTIAL_COUNT; partial++)
+                modes[chamberIndex * PARTIAL_COUNT + partial - 1] = ResonatorModeType{
+                    pChamberFrequencies[chamberIndex] * partial,
+                    RESONANCE_DECAY_TIME / partial,
+                    RESONANCE_CHAMBER_AMPLITUDE_FACTOR * ComputeResonance(FloatType(partial)),
+                };
+        return modes;
+    }
+
+    static constexpr const auto STANDARD_RESONATOR_MODES = ComputeResonatorModes(CHAMBER_FREQUENCIES);
+
 public:
     FloatType loudness;
+    FloatType mouseVelocity;
 
-    App()
-        : keyboard(), chambers(), resonances(), loudness(1600.0)
+    App(const Settings &pSettings = DEFAULT_SETTINGS)
+        : voices(pSettings, VOICE_CAPACITY, KEYBOARD_FREQUENCIES), keyboard(), resonators(pSettings, STANDARD_RESONATOR_MODES), graph(pSettings), controls(KEY_COUNT), noteEvents(), pendingEvent(), sampleTime(0), periodSampleCount(0), audioClock(AudioClockType{0, TimePointType(), 0}), eventTime(IMMEDIATE), stepTime(IMMEDIATE), stepMouseVelocity(0.0), frameStartMouseVelocity(0.0), mixer(pSettings, Callback, MASTER_GAIN), recorder(pSettings), analyser(pSettings, MixerType::FULL_SCALE / MASTER_GAIN), scope(SCOPE_CHANNEL_COUNT, SCOPE_COLUMN_COUNT), geometry(), performance(pSettings.sampleRate), overlayVisible(false), loudness(1600.0), mouseVelocity(0.0)
     {
-        // Keyboard.
-        // 4th Octave.
-        keyboard.insert({KEY_Z, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(C4, 0.0)});
-        keyboard.insert({KEY_X, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(D4, 0.0)});
-        keyboard.insert({KEY_C, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(E4, 0.0)});
-        keyboard.insert({KEY_V, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(F4, 0.0)});
-        keyboard.insert({KEY_B, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(G4, 0.0)});
-        keyboard.insert({KEY_N, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(A4, 0.0)});
-        keyboard.insert({KEY_M, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(B4, 0.0)});
-
-        // 5th Octave.
-        keyboard.insert({KEY_Q, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(C5, 0.0)});
-        keyboard.insert({KEY_W, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(D5, 0.0)});
-        keyboard.insert({KEY_E, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(E5, 0.0)});
-        keyboard.insert({KEY_R, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(F5, 0.0)});
-        keyboard.insert({KEY_T, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(G5, 0.0)});
-        keyboard.insert({KEY_Y, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(A5, 0.0)});
-        keyboard.insert({KEY_U, SynthType::CreateSynthFromWaveform<KeyboardWaveformType>(B5, 0.0)});
-
-        // Chamber.
-        // chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(C4, 0.0));
-        chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(D4, 0.0));
-        chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(E4, 0.0));
-        // chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(F4, 0.0));
-        chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(G4, 0.0));
-        chambers.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(A4, 0.0));
-        // chamber.push_back(SynthType::CreateSynthFromWaveform<ResonanceChamberWaveformType>(B4, 0.0));
+        for (SizeType keyIndex = 0; keyIndex < KEY_COUNT; keyIndex++)
+            keyboard.insert({KEYBOARD_KEYS[keyIndex], keyIndex});
+
+        const auto voicesNode = graph.AddNode(std::make_unique<VoiceBankNode<VoiceBankType>>(voices));
+        const auto resonatorsNode = graph.AddNode(std::make_unique<ResonatorBankNode<>>(resonators));
+        const auto outputNode = graph.AddNode(std::make_unique<SumNode<>>(2));
+        graph.Connect({voicesNode, 0}, resonatorsNode, 0);
+        graph.Connect({voicesNode, 0}, outputNode, 0);
+        graph.Connect({resonatorsNode, 0}, outputNode, 1);
+        graph.SetOutput({outputNode, 0});
+        graph.Compile();
     }
     ~App() override = default;
 
     auto Start() -> void override
     {
-        for (auto &[key, synth] : keyboard)
-            synth.Start();
-        for (auto &chamber : chambers)
-            chamber.Start();
+        voices.Start();
+        resonators.Start();
+        graph.Start();
+        instance.store(this, std::memory_order_release);
+        mixer.Start();
     }
 
+    // Runs on the UI thread; only publishes targets for the audio thread.
     auto Process() -> void override
     {
-        const auto mouseSpeed = Vector2Length(GetMouseDelta());
-
-        for (auto &[key, synth] : keyboard)
+        CollectPerformance();
+        if (IsKeyPressed(OVERLAY_KEY))
+            overlayVisible = !overlayVisible;
+        if (IsKeyPressed(PERFORMANCE_EXPORT_KEY))
         {
-            const auto amplitude = loudness * std::log(
-                                                  (IsKeyDown(key) ? mouseSpeed : 0.0) + 1);
-            synth.waveform->amplitude.target = amplitude;
-            synth.Process();
+            WritePerformance(PERFORMANCE_CSV_PATH);
+            WritePerformance(PERFORMANCE_JSON_PATH);
         }
+        if (IsKeyPressed(RECORD_KEY))
+        {
+            if (recorder.IsRecording())
+                StopRecording();
+            else
+                StartRecording(RECORDING_PATH);
+        }
+        if (IsKeyPressed(SPECTRUM_KEY))
+        {
+            if (analyser.IsEnabled())
+                analyser.Disable();
+            else
+                analyser.Enable();
+        }
+        analyser.Process();
+
+        const auto frameTime = GetFrameTime();
+        Perform(frameTime > 0.0f ? Vector2Length(GetMouseDelta()) / frameTime : 0.0, IsKeyDown);
+    }
 
-        for (auto &chamber : chambers)
+    // Latches input from any source; pMouseVelocity is in pixels per second and pIsKeyDown is called with each KeyboardKey.
+    template <class TIsKeyDownType>
+    auto Perform(FloatType pMouseVelocity, TIsKeyDownType &&pIsKeyDown) -> void
+    {
+        frameStartMouseVelocity = stepMouseVelocity;
+        mouseVelocity = pMouseVelocity;
+        for (const auto &[key, note] : keyboard)
         {
-            auto &chamberAmplitude = chamber.waveform->amplitude.target;
-            chamberAmplitude = 0.0;
+            auto &control = controls[note];
+            control.down = pIsKeyDown(key);
+            control.pressed = control.pressed || control.down;
+        }
+    }
+
+    // Sends pEvent to the audio thread; any single thread may call it, one at a time, with non-decreasing times.
+    // Returns false when the queue is full, in which case the caller should try again later.
+    auto Schedule(const NoteEventType &pEvent) -> BoolType
+    {
+        return noteEvents.TryPush(pEvent);
+    }
+
+    auto PlayNote(SizeType pNote, FloatType pAmplitude, SizeType pTime = IMMEDIATE) -> BoolType
+    {
+        return Schedule(NoteEventType{pTime, NoteEventKind::AMPLITUDE, pNote, pAmplitude});
+    }
 
-            for (auto &[key, synth] : keyboard)
+    auto BendNote(SizeType pNote, FloatType pRatio, SizeType pTime = IMMEDIATE) -> BoolType
+    {
+        return Schedule(NoteEventType{pTime, NoteEventKind::BEND, pNote, pRatio});
+    }
+
+    // The note closest to pFrequency within NOTE_MATCH_CENTS, or VoiceBankType::NO_NOTE.
+    static auto FindNote(FloatType pFrequency) -> SizeType
+    {
+        auto closestNote = VoiceBankType::NO_NOTE;
+        auto closestCents = NOTE_MATCH_CENTS;
+        for (SizeType note = 0; note < KEY_COUNT; note++)
+        {
+            const auto cents = std::abs(1200.0 * std::log2(pFrequency / KEYBOARD_FREQUENCIES[note]));
+            if (cents <= closestCents)
             {
-                const auto &synthFrequency = synth.waveform->frequency.ViewCurrent();
-                const auto &chamberFrequency = chamber.waveform->frequency.ViewCurrent();
-                const auto &synthAmplitude = synth.waveform->amplitude.ViewCurrent();
-                const auto intervalRatio = synthFrequency > chamberFrequency ? synthFrequency / chamberFrequency : chamberFrequency / synthFrequency;
-                if (!resonances.contains(intervalRatio))
-                    resonances.insert({intervalRatio, computeResonance(intervalRatio)});
-                const auto amplitudeFactor = resonances[intervalRatio];
-                chamberAmplitude += synthAmplitude * amplitudeFactor;
+                closestNote = note;
+                closestCents = cents;
             }
+        }
+        return closestNote;
+    }
+
+    // Runs one control step; sends the loudness targets that moved to the audio thread, stamped with pTime.
+    // The mouse velocity is pProgress of the way from the one the previous frame ended on to the one last latched.
+    auto Tick(SizeType pTime = IMMEDIATE, FloatType pProgress = 1.0) -> void
+    {
+        stepMouseVelocity = std::lerp(frameStartMouseVelocity, mouseVelocity, pProgress);
+        const auto mouseSpeed = stepMouseVelocity / MOUSE_SPEED_REFERENCE_RATE;
+        for (SizeType note = 0; note < controls.size(); note++)
+        {
+            auto &control = controls[note];
+            control.amplitude = loudness * std::log((control.down || control.pressed ? mouseSpeed : 0.0) + 1);
+            control.pressed = false;
 
-            chamber.Process();
+            // Left unsent when the queue is full, so the next tick retries it.
+            if (std::abs(control.amplitude - control.sentAmplitude) >= CONTROL_AMPLITUDE_MIN_DIFFERENCE && PlayNote(note, control.amplitude, pTime))
+                control.sentAmplitude = control.amplitude;
         }
     }
 
-    auto Draw() -> void override
+    // UI thread; runs the pStepCount control steps that cover the time since the previous frame.
+    // The mouse velocity glides across them from the previous frame's to this frame's, and each step is stamped at its
+    // own sample, one control step after the one before, ending on pTime (see EstimateEventTime), so loudness moves
+    // at the control rate even though input is only read once per frame.
+    auto TickFrame(SizeType pStepCount, SizeType pTime) -> void
+    {
+        const auto &settings = mixer.ViewSettings();
+        const auto stepSampleCount = FloatType(settings.sampleRate) / FloatType(settings.controlRate);
+        for (SizeType step = 0; step < pStepCount; step++)
+        {
+            const auto lag = SizeType(FloatType(pStepCount - 1 - step) * stepSampleCount);
+            stepTime = std::max(pTime > lag ? pTime - lag : IMMEDIATE, stepTime);
+            Tick(stepTime, FloatType(step + 1) / FloatType(pStepCount));
+        }
+    }
+
+    // UI thread; the sample time at which to play input that arrived at pTime.
+    // The audio clock is extrapolated from the last callback to pTime and one device period is added, so the event
+    // lands in the next pull at the same delay after the input every time, instead of wherever that pull starts.
+    // IMMEDIATE until the device has pulled once.
+    auto EstimateEventTime(TimePointType pTime = PerformanceMonitor::ClockType::now()) -> SizeType
+    {
+        audioClock.Update();
+        const auto &clock = audioClock.ViewFront();
+        if (clock.periodSampleCount == 0)
+            return IMMEDIATE;
+        const auto elapsed = std::max(std::chrono::duration<FloatType>(pTime - clock.time).count(), 0.0);
+        const auto time = clock.sampleTime + clock.periodSampleCount + SizeType(elapsed * mixer.ViewSettings().sampleRate);
+        eventTime = std::max(eventTime, time);
+        return eventTime;
+    }
+
+    // Runs on the audio thread; renders exactly the frames the device asks for.
+    // pSamples receives MixerType::FloatSampleType or MixerType::PcmSampleType frames, following the output bit depth.
+    auto Render(void *pSamples, SizeType pSampleCount) -> void
+    {
+        Render(pSamples, pSampleCount, PerformanceMonitor::ClockType::now());
+    }
+
+    // pCallbackTime is when the device asked for the samples, on the clock EstimateEventTime is given.
+    auto Render(void *pSamples, SizeType pSampleCount, TimePointType pCallbackTime) -> void
+    {
+        const auto startTime = performance.BeginBlock();
+        periodSampleCount = std::max(periodSampleCount, pSampleCount);
+        audioClock.AccessBack() = AudioClockType{sampleTime, pCallbackTime, periodSampleCount};
+        audioClock.Publish();
+
+        scope.Begin(pSampleCount);
+        for (SizeType renderedSampleCount = 0; renderedSampleCount < pSampleCount;)
+        {
+            const auto sampleCount = std::min({pSampleCount - renderedSampleCount, mixer.ViewSettings().blockSize, ApplyDueEvents()});
+            graph.Render(sampleCount);
+            analyser.Push(graph.ViewOutput().data(), sampleCount);
+            CaptureScopes(renderedSampleCount, sampleCount);
+            mixer.Accumulate(graph.ViewOutput(), sampleCount);
+            mixer.Flush(pSamples, renderedSampleCount, sampleCount);
+
+            renderedSampleCount += sampleCount;
+            sampleTime += sampleCount;
+        }
+        scope.Publish();
+
+        if (mixer.IsFloatOutput())
+            recorder.Record(static_cast<const MixerType::FloatSampleType *>(pSamples), pSampleCount);
+        else
+            recorder.Record(static_cast<const MixerType::PcmSampleType *>(pSamples), pSampleCount);
+        performance.EndBlock(startTime, pSampleCount, voices.ViewActiveVoiceCount());
+    }
+
+    // Records the output to pPath in the background until StopRecording or Finish; see Recorder.
+    auto StartRecording(const std::string &pPath) -> BoolType
     {
-        const auto screenCenterX = GetScreenWidth() / 2;
-        const auto screenCenterY = GetScreenHeight() / 2;
-        const auto mouseSpeed = Vector2Length(GetMouseDelta());
-        const auto shortestScreenEdgeLength = std::min(GetScreenHeight(), GetScreenHeight());
-        const auto longestScreenEdgeLength = std::max(GetScreenHeight(), GetScreenHeight());
+        return recorder.Start(pPath);
+    }
+
+    auto StopRecording() -> void
+    {
+        recorder.Stop();
+    }
+
+    // Runs on the audio thread; applies every event due by `sampleTime` and returns the samples until the next one.
+    auto ApplyDueEvents() -> SizeType
+    {
+        while (true)
+        {
+            if (!pendingEvent)
+                pendingEvent = noteEvents.TryPop();
+            if (!pendingEvent)
+                return std::numeric_limits<SizeType>::max();
+            if (pendingEvent->time > sampleTime)
+                return pendingEvent->time - sampleTime;
+            if (pendingEvent->kind == NoteEventKind::BEND)
+                voices.SetNoteBend(pendingEvent->note, pendingEvent->value);
+            else
+                voices.SetNoteAmplitude(pendingEvent->note, pendingEvent->value);
+            pendingEvent.reset();
+        }
+    }
+
+    auto ViewSampleTime() const -> SizeType { return sampleTime; }
+
+    // Not thread-safe; call before Start. See VoiceBank::SetMinParallelSampleCount.
+    auto SetMinParallelSampleCount(SizeType pSampleCount) -> void
+    {
+        voices.SetMinParallelSampleCount(pSampleCount);
+    }
+
+    // Runs on the audio thread; adds the sub-block just rendered, pOffset samples into the callback, to the scope frame
+    // of every sounding note, every chamber and the master bus. Notes without a voice are skipped and read as silent,
+    // so the cost follows the voices playing rather than the keyboard.
+    auto CaptureScopes(SizeType pOffset, SizeType pSampleCount) -> void
+    {
+        for (SizeType note = 0; note < KEY_COUNT; note++)
+        {
+            if (voices.ViewNoteVoice(note) == VoiceBankType::NO_VOICE)
+                continue;
+            const auto samples = voices.ViewNoteSamples(note);
+            scope.Capture(note, pOffset, pSampleCount, [&samples](SizeType pIndex)
+                          { return samples[pIndex]; });
+        }
+        // A chamber's string is the sum of its partials.
+        for (SizeType chamberIndex = 0; chamberIndex < CHAMBER_COUNT; chamberIndex++)
+            scope.Capture(SCOPE_CHAMBER_CHANNEL + chamberIndex, pOffset, pSampleCount, [this, chamberIndex](SizeType pIndex)
+                          {
+                              auto sample = 0.0f;
+                              for (SizeType partial = 0; partial < PARTIAL_COUNT; partial++)
+                                  sample += resonators.ViewModeSample(chamberIndex * PARTIAL_COUNT + partial, pIndex);
+                              return sample; });
+        const auto master = graph.ViewOutput();
+        scope.Capture(SCOPE_MASTER_CHANNEL, pOffset, pSampleCount, [&master](SizeType pIndex)
+                      { return master[pIndex]; });
+    }
+
+    auto ViewPerformance() const -> const PerformanceMonitor & { return performance; }
+
+    // Drains the audio thread's block records; Process() does this every frame.
+    auto CollectPerformance() -> void
+    {
+        performance.Collect();
+    }
+
+    // Writes the collected block history as JSON when pPath ends in `.json`, and as CSV otherwise.
+    auto WritePerformance(const std::string &pPath) const -> BoolType
+    {
+        auto stream = std::ofstream(pPath);
+        if (!stream.is_open())
+        {
+            TraceLog(LOG_WARNING, "Could not write performance log %s.", pPath.c_str());
+            return false;
+        }
+        if (pPath.ends_with(".json"))
+            performance.WriteJson(stream);
+        else
+            performance.WriteCsv(stream);
+        TraceLog(LOG_INFO, "Wrote %zu blocks of performance data to %s.", performance.ViewHistorySize(), pPath.c_str());
+        return true;
+    }
+
+    // Screen-space geometry of the waveform views, generated without touching the GPU.
+    auto BuildGeometry(IntType pScreenWidth, IntType pScreenHeight) -> const GeometryType &
+    {
+        const auto screenCenterX = pScreenWidth / 2;
+        const auto screenCenterY = pScreenHeight / 2;
+        const auto shortestScreenEdgeLength = std::min(pScreenHeight, pScreenHeight);
+        const auto longestScreenEdgeLength = std::max(pScreenHeight, pScreenHeight);
         const auto centerCircleSize = shortestScreenEdgeLength * 0.05;
-        DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), DARK_COLOR);
-        DrawCircle(screenCenterX, screenCenterY, centerCircleSize, GREY_COLOR);
+        geometry.centerCircleSize = centerCircleSize;
+        geometry.keyMarkerSize = shortestScreenEdgeLength * 0.01;
+        geometry.chamberPoints.clear();
+        geometry.masterPoints.clear();
+        geometry.keyPoints.clear();
+        geometry.keyMarkers.clear();
+        geometry.spectrumPoints.clear();
+        geometry.spectrumMarkers.clear();
+
+        // Only the published snapshot is read here, never the audio thread's live buffers.
+        const auto &frame = scope.Update();
+        const auto columnCount = frame.columnCount;
+        const auto columnSpacing = FloatType(pScreenWidth) / std::max(columnCount - 1, SizeType(1));
+        const auto pushScope = [&](std::vector<Vector2> &pPoints, SizeType pChannel, FloatType pBaseY, FloatType pScale)
+        {
+            for (SizeType column = 0; column < columnCount; column++)
+            {
+                const auto x = float(column * columnSpacing);
+                pPoints.push_back({x, float(pBaseY + scope.ViewMinimum(frame, pChannel, column) * pScale)});
+                pPoints.push_back({x, float(pBaseY + scope.ViewMaximum(frame, pChannel, column) * pScale)});
+            }
+        };
 
         {
-            auto chamberIndex = SizeType(0);
-            const auto chamberCount = chambers.size();
-            for (const auto &chamber : chambers)
+            for (SizeType chamberIndex = 0; chamberIndex < CHAMBER_COUNT; chamberIndex++)
             {
-                const auto chamberIndexProportion = FloatType(chamberIndex) / (chamberCount - 1);
-                const auto baseY = std::lerp(GetScreenHeight() * 0.05, GetScreenHeight() * 0.95, chamberIndexProportion);
+                const auto chamberIndexProportion = FloatType(chamberIndex) / (CHAMBER_COUNT - 1);
+                const auto baseY = std::lerp(pScreenHeight * 0.05, pScreenHeight * 0.95, chamberIndexProportion);
+                pushScope(geometry.chamberPoints, SCOPE_CHAMBER_CHANNEL + chamberIndex, baseY, 16.0 / AVERAGE_AMPLITUDE);
+            }
+            geometry.chamberStripLength = columnCount * 2;
+            pushScope(geometry.masterPoints, SCOPE_MASTER_CHANNEL, screenCenterY, 8.0 / AVERAGE_AMPLITUDE);
+        }
 
-                const auto &samples = chamber.waveform->ViewSamples();
-                const auto sampleCount = samples.size();
-                for (SizeType sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++)
+        {
+            const auto keyCount = keyboard.size();
+            if (geometry.keyDirections.size() != keyCount)
+            {
+                geometry.keyDirections.clear();
+                for (SizeType keyIndex = 0; keyIndex < keyCount; keyIndex++)
                 {
-                    const auto sampleIndexProportion = FloatType(sampleIndex) / sampleCount;
-                    DrawPixel(
-                        GetScreenWidth() * sampleIndexProportion,
-                        baseY + FloatType(samples[sampleIndex]) * 16.0 / AVERAGE_AMPLITUDE,
-                        DARK_GREY_COLOR);
+                    const auto keyIndexDiminishedProportion = FloatType(keyIndex) / keyCount;
+                    geometry.keyDirections.push_back({float(std::sin(2 * PI * keyIndexDiminishedProportion)), float(std::cos(2 * PI * keyIndexDiminishedProportion))});
+                }
+            }
+            if (geometry.ringDirections.size() != columnCount)
+            {
+                geometry.ringDirections.clear();
+                for (SizeType column = 0; column < columnCount; column++)
+                {
+                    const auto columnProportion = FloatType(column) / columnCount;
+                    geometry.ringDirections.push_back({float(std::sin(2 * PI * columnProportion)), float(std::cos(2 * PI * columnProportion))});
                 }
-
-                chamberIndex++;
             }
-        }
 
-        {
             auto keyIndex = SizeType(0);
-            const auto keyCount = keyboard.size();
             const auto maxAmplitudeDisplacement = (shortestScreenEdgeLength / 2) * 0.8;
             const auto minAmplitudeDisplacement = maxAmplitudeDisplacement * 0.9;
-            for (const auto &[key, synth] : keyboard)
+            for (const auto &[key, note] : keyboard)
             {
                 const auto keyIndexDiminishedProportion = FloatType(keyIndex) / (keyCount);
 
-                const auto &samples = synth.waveform->ViewSamples();
-                const auto sampleCount = samples.size();
-                for (SizeType sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++)
+                const auto frequencyBaseRadius = std::lerp(centerCircleSize * 1.5, longestScreenEdgeLength * 0.8, keyIndexDiminishedProportion);
+                const auto pushRingPoint = [&](SizeType pColumn, Scope::ValueType pSample)
+                {
+                    const auto &direction = geometry.ringDirections[pColumn];
+                    const auto frequencyRadius = frequencyBaseRadius + FloatType(pSample) * 8.0 / AVERAGE_AMPLITUDE;
+                    geometry.keyPoints.push_back({
+                        float(screenCenterX + frequencyRadius * direction.x),
+                        float(screenCenterY + frequencyRadius * direction.y),
+                    });
+                };
+                for (SizeType column = 0; column < columnCount; column++)
                 {
-                    const auto sampleIndexProportion = FloatType(sampleIndex) / sampleCount;
-                    const auto frequencyBaseRadius = std::lerp(centerCircleSize * 1.5, longestScreenEdgeLength * 0.8, keyIndexDiminishedProportion);
-                    const auto frequencyRadius = frequencyBaseRadius + FloatType(samples[sampleIndex]) * 8.0 / AVERAGE_AMPLITUDE;
-                    DrawPixel(
-                        screenCenterX + frequencyRadius * std::sin(2 * PI * sampleIndexProportion),
-                        screenCenterY + frequencyRadius * std::cos(2 * PI * sampleIndexProportion),
-                        DARK_GREY_COLOR);
+                    pushRingPoint(column, scope.ViewMinimum(frame, note, column));
+                    pushRingPoint(column, scope.ViewMaximum(frame, note, column));
                 }
-
-                const auto amplitudeDisplacement = std::lerp(minAmplitudeDisplacement, maxAmplitudeDisplacement, std::clamp(synth.waveform->amplitude.ViewCurrent() / AVERAGE_AMPLITUDE, 0.0, 1.0));
-                DrawCircle(
-                    screenCenterX + amplitudeDisplacement * std::sin(2 * PI * keyIndexDiminishedProportion),
-                    screenCenterY + amplitudeDisplacement * std::cos(2 * PI * keyIndexDiminishedProportion),
-                    shortestScreenEdgeLength * 0.01,
-                    LIGHT_COLOR);
+                // The last point closes the ring.
+                pushRingPoint(0, scope.ViewMinimum(frame, note, 0));
+                geometry.keyStripLength = columnCount * 2 + 1;
+
+                const auto amplitude = controls[note].amplitude;
+                const auto amplitudeDisplacement = std::lerp(minAmplitudeDisplacement, maxAmplitudeDisplacement, std::clamp(amplitude / AVERAGE_AMPLITUDE, 0.0, 1.0));
+                const auto &keyDirection = geometry.keyDirections[keyIndex];
+                geometry.keyMarkers.push_back({
+                    float(screenCenterX + amplitudeDisplacement * keyDirection.x),
+                    float(screenCenterY + amplitudeDisplacement * keyDirection.y),
+                });
                 keyIndex++;
             }
         }
 
+        if (analyser.IsEnabled())
+            BuildSpectrum(pScreenWidth, pScreenHeight);
+
+        return geometry;
+    }
+
+    // Each point takes the loudest bin between its frequency and the next point's, so narrow peaks stay visible at the top.
+    auto BuildSpectrum(IntType pScreenWidth, IntType pScreenHeight) -> void
+    {
+        const auto levels = analyser.ViewLevels();
+        const auto binWidth = analyser.ViewBinFrequency(1);
+        const auto maxFrequency = analyser.ViewBinFrequency(levels.size() - 1);
+        const auto octaveCount = std::log2(maxFrequency / SPECTRUM_MIN_FREQUENCY);
+        const auto frequencyAt = [&](FloatType pX)
+        { return SPECTRUM_MIN_FREQUENCY * std::exp2(octaveCount * pX / pScreenWidth); };
+        const auto xAt = [&](FloatType pFrequency)
+        { return float(pScreenWidth * std::log2(pFrequency / SPECTRUM_MIN_FREQUENCY) / octaveCount); };
+        const auto scale = pScreenHeight * SPECTRUM_HEIGHT_RATIO / -SpectrumAnalyserType::MIN_DECIBELS;
+
+        for (IntType x = 0; x <= pScreenWidth; x += SPECTRUM_POINT_SPACING)
+        {
+            const auto firstBin = std::min(SizeType(frequencyAt(x) / binWidth + 0.5), levels.size() - 1);
+            const auto lastBin = std::clamp(SizeType(frequencyAt(x + SPECTRUM_POINT_SPACING) / binWidth + 0.5), firstBin + 1, levels.size());
+            const auto level = *std::max_element(levels.begin() + firstBin, levels.begin() + lastBin);
+            geometry.spectrumPoints.push_back({float(x), float(pScreenHeight - (level - SpectrumAnalyserType::MIN_DECIBELS) * scale)});
+        }
+        for (const auto frequency : CHAMBER_FREQUENCIES)
+        {
+            geometry.spectrumMarkers.push_back({xAt(frequency), float(pScreenHeight)});
+            geometry.spectrumMarkers.push_back({xAt(frequency), float(pScreenHeight * (1.0 - SPECTRUM_HEIGHT_RATIO))});
+        }
+    }
+
+    // Every strip is submitted as one line strip; consecutive strips share raylib's render batch,
+    // so each layer costs a single draw call instead of one call per sample.
+    auto Draw() -> void override
+    {
+        BuildGeometry(GetScreenWidth(), GetScreenHeight());
+        DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), DARK_COLOR);
+        DrawCircle(GetScreenWidth() / 2, GetScreenHeight() / 2, geometry.centerCircleSize, GREY_COLOR);
+
+        for (SizeType offset = 0; offset < geometry.chamberPoints.size(); offset += geometry.chamberStripLength)
+            DrawLineStrip(geometry.chamberPoints.data() + offset, geometry.chamberStripLength, DARK_GREY_COLOR);
+        DrawLineStrip(geometry.masterPoints.data(), geometry.masterPoints.size(), GREY_COLOR);
+        for (SizeType offset = 0; offset < geometry.keyPoints.size(); offset += geometry.keyStripLength)
+            DrawLineStrip(geometry.keyPoints.data() + offset, geometry.keyStripLength, DARK_GREY_COLOR);
+        for (const auto &marker : geometry.keyMarkers)
+            DrawCircle(marker.x, marker.y, geometry.keyMarkerSize, LIGHT_COLOR);
+        for (SizeType offset = 0; offset + 1 < geometry.spectrumMarkers.size(); offset += 2)
+            DrawLineV(geometry.spectrumMarkers[offset], geometry.spectrumMarkers[offset + 1], DARK_GREY_COLOR);
+        DrawLineStrip(geometry.spectrumPoints.data(), geometry.spectrumPoints.size(), LIGHT_COLOR);
+
         DrawText(ENGRAVING, 5, 5, 10, DARK_GREY_COLOR);
+        if (recorder.IsRecording())
+            DrawText("Recording", GetScreenWidth() - 60, 5, 10, LIGHT_COLOR);
+        if (overlayVisible)
+            DrawOverlay();
+    }
+
+    // Live audio performance counters, toggled with OVERLAY_KEY.
+    // TextFormat reuses a handful of static buffers, so every line is drawn as soon as it is formatted.
+    auto DrawOverlay() const -> void
+    {
+        const auto &settings = mixer.ViewSettings();
+        DrawText(TextFormat("DSP load %5.1f%% (peak %5.1f%%)", performance.ViewRecentLoad() * 100.0, performance.ViewRecentPeakLoad() * 100.0), 5, 20, 10, LIGHT_COLOR);
+        DrawText(TextFormat("Block %zu samples, %.2f ms deadline", settings.blockSize, settings.ComputeBlockDuration() * 1000.0), 5, 32, 10, LIGHT_COLOR);
+        DrawText(TextFormat("Late %zu, missed %zu of %zu callbacks", performance.ViewLateBlockCount(), performance.ViewMissedBlockCount(), performance.ViewBlockCount()), 5, 44, 10, LIGHT_COLOR);
+        DrawText(TextFormat("Voices %zu / %zu", performance.ViewActiveVoiceCount(), voices.ViewVoiceCapacity()), 5, 56, 10, LIGHT_COLOR);
+        DrawText(TextFormat("Resonators %zu modes, %s", resonators.ViewModeCount(), resonators.IsResting() ? "resting" : "ringing"), 5, 68, 10, LIGHT_COLOR);
     }
 
     auto Finish() -> void override
     {
-        for (auto &[key, synth] : keyboard)
-            synth.Finish();
-        for (auto &chamber : chambers)
-            chamber.Finish();
+        mixer.Finish();
+        instance.store(nullptr, std::memory_order_release);
+        recorder.Finish();
+        voices.Finish();
+        resonators.Finish();
+        graph.Finish();
     }
 };
 
@@ -2,27 +2,34 @@
 #include <string>
 
 #include "definition.hpp"
+#include "settings.hpp"
 #include "app.hpp"
+#include "utilities/fixed_step.hpp"
 
 constexpr const IntType DEFAULT_SCREEN_WIDTH = 800;
 constexpr const IntType DEFAULT_SCREEN_HEIGHT = 450;
-constexpr const IntType DEFAULT_TARGET_FPS = 30;
 constexpr const CharType *DEFAULT_TITLE = "Gracile";
 
-int main()
+int main(int argc, char **argv)
 {
-    auto app = App();
+    const auto settings = ParseSettings(argc, argv);
+    auto app = App(settings);
+    auto control = FixedStep(settings.controlRate);
 
     SetConfigFlags(FLAG_MSAA_4X_HINT);
     InitWindow(DEFAULT_SCREEN_WIDTH, DEFAULT_SCREEN_HEIGHT, DEFAULT_TITLE);
     InitAudioDevice();
-    SetTargetFPS(DEFAULT_TARGET_FPS);
+    SetTargetFPS(IntType(settings.frameRate));
     app.Start();
 
     while (!WindowShouldClose())
     {
         {
+            // Input is polled once per frame; the control state advances in fixed steps however long the frame took,
+            // stamped to play one device period after the audio clock reached each step.
             app.Process();
+            const auto eventTime = app.EstimateEventTime();
+            app.TickFrame(control.Advance(GetFrameTime()), eventTime);
         }
 
         {
@@ -35,4 +42,4 @@ int main()
     app.Finish();
     CloseAudioDevice();
     CloseWindow();
-}
\ No newline at end of file
+}
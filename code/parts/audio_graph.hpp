@@ -0,0 +1,301 @@
+#ifndef AUDIO_GRAPH_HPP
+#define AUDIO_GRAPH_HPP
+
+#include <memory>
+#include <vector>
+#include <span>
+#include <limits>
+#include <algorithm>
+#include <raylib.h>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+#include "nodes/audio_node.hpp"
+#include "utilities/simd.hpp"
+#include "utilities/aligned_allocator.hpp"
+
+// Pull-model graph of AudioNodes, rendered one block at a time in topological order.
+//
+// Nodes are added and wired up front; Compile() then orders them so that every node runs after the nodes it reads
+// from, and assigns the graph-provided output buffers. A buffer is returned to a free list as soon as the last node
+// reading it has been scheduled, and handed to the next output that needs one, so the number of buffers follows the
+// widest point of the graph rather than its size. All buffers, plus one of silence for unconnected inputs, live in
+// a single aligned arena allocated by Compile(); Render() only walks precomputed pointer tables.
+template <class = void>
+class AudioGraph final : public Part<>
+{
+public:
+    using NodeType = AudioNode<>;
+    using ValueType = NodeType::ValueType;
+    using NodeLeashType = std::unique_ptr<NodeType>;
+    using ArrayType = std::vector<ValueType, AlignedAllocator<ValueType, FloatLanes::ALIGNMENT>>;
+    using SamplesViewType = std::span<const ValueType>;
+    using IndicesType = std::vector<SizeType>;
+
+    // Output port pPort of node pNode.
+    struct EndpointType
+    {
+        SizeType node;
+        SizeType port;
+    };
+
+    static constexpr const SizeType NO_NODE = std::numeric_limits<SizeType>::max();
+    static constexpr const SizeType NO_BUFFER = std::numeric_limits<SizeType>::max();
+
+private:
+    struct EntryType
+    {
+        NodeLeashType node;
+        // One per input port; `node` is NO_NODE while the port is unconnected.
+        std::vector<EndpointType> sources;
+        // Offsets of the node's ports into the flat port tables below.
+        SizeType inputOffset;
+        SizeType outputOffset;
+    };
+
+    Settings settings;
+    std::vector<EntryType> entries;
+    EndpointType output;
+    BoolType compiled;
+
+    IndicesType schedule;
+    SizeType bufferStride;
+    SizeType bufferCount;
+    ArrayType arena;
+    std::vector<const ValueType *> inputPointers;
+    std::vector<ValueType *> outputPointers;
+    const ValueType *outputPointer;
+
+    auto isValidOutput(EndpointType pEndpoint) const -> BoolType
+    {
+        return pEndpoint.node < entries.size() && pEndpoint.port < entries[pEndpoint.node].node->ViewOutputCount();
+    }
+
+    // Kahn's algorithm, taking ready nodes in the order they were added; false if the graph has a cycle.
+    auto sort() -> BoolType
+    {
+        auto pendingInputCounts = IndicesType(entries.size(), 0);
+        auto consumers = std::vector<IndicesType>(entries.size());
+        for (SizeType node = 0; node < entries.size(); node++)
+            for (const auto &source : entries[node].sources)
+                if (source.node != NO_NODE)
+                {
+                    pendingInputCounts[node]++;
+                    consumers[source.node].push_back(node);
+                }
+
+        schedule.clear();
+        for (SizeType node = 0; node < entries.size(); node++)
+            if (pendingInputCounts[node] == 0)
+                schedule.push_back(node);
+        for (SizeType scheduled = 0; scheduled < schedule.size(); scheduled++)
+            for (const auto consumer : consumers[schedule[scheduled]])
+                if (--pendingInputCounts[consumer] == 0)
+                    schedule.push_back(consumer);
+        return schedule.size() == entries.size();
+    }
+
+    // Assigns a buffer to every graph-provided output port, in schedule order, reusing the buffers of dead outputs.
+    auto allocate() -> IndicesType
+    {
+        auto portCount = SizeType(0);
+        for (auto &entry : entries)
+        {
+            entry.outputOffset = portCount;
+            portCount += entry.node->ViewOutputCount();
+        }
+
+        auto remainingReadCounts = IndicesType(portCount, 0);
+        for (const auto &entry : entries)
+            for (const auto &source : entry.sources)
+                if (source.node != NO_NODE)
+                    remainingReadCounts[entries[source.node].outputOffset + source.port]++;
+        // The graph output is read after the last node, so it is never released.
+        remainingReadCounts[entries[output.node].outputOffset + output.port]++;
+
+        auto buffers = IndicesType(portCount, NO_BUFFER);
+        auto freeBuffers = IndicesType();
+        bufferCount = 0;
+        const auto release = [&](SizeType pPort)
+        {
+            if (buffers[pPort] != NO_BUFFER && --remainingReadCounts[pPort] == 0)
+                freeBuffers.push_back(buffers[pPort]);
+        };
+        for (const auto node : schedule)
+        {
+            const auto &entry = entries[node];
+            const auto outputCount = entry.node->ViewOutputCount();
+            // Outputs are assigned before the inputs are released, so a node never writes over what it reads.
+            for (SizeType port = 0; port < outputCount; port++)
+            {
+                if (entry.node->ViewOwnedOutput(port) != nullptr)
+                    continue;
+                if (freeBuffers.empty())
+                    buffers[entry.outputOffset + port] = bufferCount++;
+                else
+                {
+                    buffers[entry.outputOffset + port] = freeBuffers.back();
+                    freeBuffers.pop_back();
+                }
+            }
+            for (const auto &source : entry.sources)
+                if (source.node != NO_NODE)
+                    release(entries[source.node].outputOffset + source.port);
+            // Outputs nobody reads are still written, but free again right after the node.
+            for (SizeType port = 0; port < outputCount; port++)
+                if (remainingReadCounts[entry.outputOffset + port] == 0)
+                {
+                    remainingReadCounts[entry.outputOffset + port] = 1;
+                    release(entry.outputOffset + port);
+                }
+        }
+        return buffers;
+    }
+
+public:
+    explicit AudioGraph(const Settings &pSettings)
+        : settings(pSettings),
+          entries(),
+          output{NO_NODE, 0},
+          compiled(false),
+          schedule(),
+          bufferStride(0),
+          bufferCount(0),
+          arena(),
+          inputPointers(),
+          outputPointers(),
+          outputPointer(nullptr) {}
+    AudioGraph(const AudioGraph &) = delete;
+    auto operator=(const AudioGraph &) -> AudioGraph & = delete;
+    ~AudioGraph() override = default;
+
+    // Takes ownership of pNode and returns its index.
+    auto AddNode(NodeLeashType pNode) -> SizeType
+    {
+        const auto inputCount = pNode->ViewInputCount();
+        entries.push_back(EntryType{std::move(pNode), std::vector<EndpointType>(inputCount, EndpointType{NO_NODE, 0}), 0, 0});
+        compiled = false;
+        return entries.size() - 1;
+    }
+
+    // Feeds input pInput of pNode from pSource; each input has at most one source, so mixing takes a SumNode.
+    auto Connect(EndpointType pSource, SizeType pNode, SizeType pInput) -> BoolType
+    {
+        if (!isValidOutput(pSource) || pNode >= entries.size() || pInput >= entries[pNode].sources.size())
+        {
+            TraceLog(LOG_WARNING, "Audio graph: cannot connect node %zu output %zu to node %zu input %zu.", pSource.node, pSource.port, pNode, pInput);
+            return false;
+        }
+        entries[pNode].sources[pInput] = pSource;
+        compiled = false;
+        return true;
+    }
+
+    // The endpoint whose block ViewOutput() returns after each Render().
+    auto SetOutput(EndpointType pOutput) -> BoolType
+    {
+        if (!isValidOutput(pOutput))
+        {
+            TraceLog(LOG_WARNING, "Audio graph: node %zu has no output %zu.", pOutput.node, pOutput.port);
+            return false;
+        }
+        output = pOutput;
+        compiled = false;
+        return true;
+    }
+
+    // Schedules the nodes and allocates every buffer; call once the graph is wired, outside the audio thread.
+    auto Compile() -> BoolType
+    {
+        compiled = false;
+        outputPointer = nullptr;
+        if (output.node == NO_NODE)
+        {
+            TraceLog(LOG_ERROR, "Audio graph: no output set.");
+            return false;
+        }
+        if (!sort())
+        {
+            TraceLog(LOG_ERROR, "Audio graph: the connections form a cycle.");
+            return false;
+        }
+
+        const auto buffers = allocate();
+        const auto alignmentCount = FloatLanes::ALIGNMENT / sizeof(ValueType);
+        bufferStride = (settings.blockSize + alignmentCount - 1) / alignmentCount * alignmentCount;
+        // The last buffer stays silent for unconnected inputs.
+        arena.assign((bufferCount + 1) * bufferStride, 0.0f);
+        const auto *silence = arena.data() + bufferCount * bufferStride;
+
+        const auto outputAt = [&](EndpointType pEndpoint) -> ValueType *
+        {
+            const auto buffer = buffers[entries[pEndpoint.node].outputOffset + pEndpoint.port];
+            return buffer == NO_BUFFER ? nullptr : arena.data() + buffer * bufferStride;
+        };
+        const auto sourceAt = [&](EndpointType pEndpoint) -> const ValueType *
+        {
+            if (pEndpoint.node == NO_NODE)
+                return silence;
+            const auto *owned = entries[pEndpoint.node].node->ViewOwnedOutput(pEndpoint.port);
+            return owned != nullptr ? owned : outputAt(pEndpoint);
+        };
+
+        inputPointers.clear();
+        outputPointers.clear();
+        for (SizeType node = 0; node < entries.size(); node++)
+        {
+            auto &entry = entries[node];
+            entry.inputOffset = inputPointers.size();
+            for (const auto &source : entry.sources)
+                inputPointers.push_back(sourceAt(source));
+            for (SizeType port = 0; port < entry.node->ViewOutputCount(); port++)
+                outputPointers.push_back(outputAt(EndpointType{node, port}));
+        }
+        outputPointer = sourceAt(output);
+        compiled = true;
+        return true;
+    }
+
+    auto IsCompiled() const -> BoolType { return compiled; }
+    auto ViewNodeCount() const -> SizeType { return entries.size(); }
+    // Graph-provided buffers after reuse, not counting the silent one.
+    auto ViewBufferCount() const -> SizeType { return bufferCount; }
+    auto ViewSchedule() const -> std::span<const SizeType> { return schedule; }
+
+    auto AccessNode(SizeType pNode) -> NodeType & { return *entries[pNode].node; }
+
+    auto ViewOutput() const -> SamplesViewType
+    {
+        return SamplesViewType(outputPointer, outputPointer == nullptr ? 0 : settings.blockSize);
+    }
+
+    // Runs every node once over pSampleCount samples; does nothing until the graph is compiled.
+    auto Render(SizeType pSampleCount) -> void
+    {
+        if (!compiled)
+            return;
+        for (const auto node : schedule)
+        {
+            auto &entry = entries[node];
+            entry.node->Render(
+                NodeType::InputsType(inputPointers.data() + entry.inputOffset, entry.sources.size()),
+                NodeType::OutputsType(outputPointers.data() + entry.outputOffset, entry.node->ViewOutputCount()),
+                pSampleCount);
+        }
+    }
+
+    auto Start() -> void override
+    {
+        for (auto &entry : entries)
+            entry.node->Start();
+    }
+
+    auto Finish() -> void override
+    {
+        for (auto &entry : entries)
+            entry.node->Finish();
+    }
+};
+
+#endif // AUDIO_GRAPH_HPP
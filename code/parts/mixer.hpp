@@ -0,0 +1,120 @@
+#ifndef MIXER_HPP
+#define MIXER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <raylib.h>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+
+// Sums every source of a block in float32 and converts the result once, at the output.
+// Sources keep amplitudes in 16-bit full-scale units; the output is either 32-bit float, scaled to [-1, 1],
+// or 16-bit PCM, optionally with triangular (TPDF) dither of one least significant bit.
+template <class = void>
+class Mixer final : public Part<>
+{
+public:
+    using ValueType = float;
+    using AccumulatorType = std::vector<ValueType>;
+    using CallbackType = AudioCallback;
+    using FloatSampleType = float;
+    using PcmSampleType = short;
+
+    static constexpr const SizeType CHANNEL_COUNT = 1;
+    static constexpr const ValueType FULL_SCALE = 32768.0f;
+
+private:
+    Settings settings;
+    AudioStream stream;
+    BoolType streaming;
+    AccumulatorType accumulator;
+    CallbackType callback;
+    std::uint32_t ditherState;
+
+    // xorshift32, uniform in [0, 1); deterministic so offline renders stay reproducible.
+    auto nextUniform() -> ValueType
+    {
+        ditherState ^= ditherState << 13;
+        ditherState ^= ditherState >> 17;
+        ditherState ^= ditherState << 5;
+        return ValueType(ditherState >> 8) * (1.0f / 16777216.0f);
+    }
+
+public:
+    FloatType gain;
+
+    // pCallback is invoked on the audio thread whenever the device needs more frames.
+    Mixer(const Settings &pSettings, CallbackType pCallback, FloatType pGain = 1.0)
+        : settings(pSettings), stream(), streaming(false), accumulator(pSettings.blockSize, 0.0f), callback(pCallback), ditherState(0x9E3779B9u), gain(pGain) {}
+    ~Mixer() override = default;
+
+    auto ViewSettings() const -> const Settings &
+    {
+        return settings;
+    }
+
+    auto IsFloatOutput() const -> BoolType { return settings.outputBitDepth == 32; }
+
+    template <class TBufferType>
+    auto Accumulate(const TBufferType &pSamples, SizeType pSampleCount) -> void
+    {
+        const auto sampleCount = std::min({pSampleCount, pSamples.size(), accumulator.size()});
+        for (SizeType i = 0; i < sampleCount; i++)
+            accumulator[i] += ValueType(pSamples[i]);
+    }
+
+    // Gain-stages and clips the summed block once, straight into the output buffer at frame pOffset.
+    // pSamples holds FloatSampleType or PcmSampleType frames, following Settings::outputBitDepth.
+    auto Flush(void *pSamples, SizeType pOffset, SizeType pSampleCount) -> void
+    {
+        const auto sampleCount = std::min(pSampleCount, accumulator.size());
+        const auto outputGain = ValueType(gain);
+        if (IsFloatOutput())
+        {
+            auto *samples = static_cast<FloatSampleType *>(pSamples) + pOffset;
+            const auto floatGain = outputGain / FULL_SCALE;
+            for (SizeType i = 0; i < sampleCount; i++)
+                samples[i] = std::clamp(accumulator[i] * floatGain, -1.0f, 1.0f);
+        }
+        else
+        {
+            auto *samples = static_cast<PcmSampleType *>(pSamples) + pOffset;
+            const auto dither = settings.dither;
+            for (SizeType i = 0; i < sampleCount; i++)
+            {
+                auto value = accumulator[i] * outputGain;
+                // Rounded to nearest rather than truncated toward zero, which would add a bias and odd harmonics.
+                value = std::nearbyint(dither ? value + nextUniform() - nextUniform() : value);
+                samples[i] = static_cast<PcmSampleType>(std::clamp(value, -FULL_SCALE, FULL_SCALE - 1.0f));
+            }
+        }
+        std::fill(accumulator.begin(), accumulator.begin() + sampleCount, 0.0f);
+    }
+
+    // Without an audio device the mixer still sums and converts, so blocks can be rendered offline.
+    auto Start() -> void override
+    {
+        streaming = IsAudioDeviceReady();
+        if (!streaming)
+            return;
+        SetAudioStreamBufferSizeDefault(settings.blockSize);
+        stream = LoadAudioStream(settings.sampleRate, settings.outputBitDepth, CHANNEL_COUNT);
+        SetAudioStreamCallback(stream, callback);
+        PlayAudioStream(stream);
+    }
+
+    auto Finish() -> void override
+    {
+        if (!streaming)
+            return;
+        streaming = false;
+        StopAudioStream(stream);
+        UnloadAudioStream(stream);
+    }
+};
+
+#endif // MIXER_HPP
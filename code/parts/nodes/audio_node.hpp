@@ -0,0 +1,40 @@
+#ifndef AUDIO_NODE_HPP
+#define AUDIO_NODE_HPP
+
+#include <span>
+
+#include "definition.hpp"
+#include "parts/part.hpp"
+
+// A stage of an AudioGraph: reads a block from each input port and writes a block to each output port.
+// Every port carries one float32 block of Settings::blockSize samples. Unconnected inputs read silence.
+//
+// By default the graph hands the node a buffer for each output. A node that already renders into storage of its
+// own (a VoiceBank's mix, say) returns that storage from ViewOwnedOutput instead; consumers then read it in place,
+// and the node receives a null pointer for that port.
+template <class = void>
+class AudioNode : public Part<>
+{
+public:
+    using ValueType = float;
+    using InputsType = std::span<const ValueType *const>;
+    using OutputsType = std::span<ValueType *const>;
+
+    virtual ~AudioNode() = 0;
+
+    virtual auto ViewInputCount() const -> SizeType = 0;
+    virtual auto ViewOutputCount() const -> SizeType = 0;
+
+    virtual auto ViewOwnedOutput(SizeType) const -> const ValueType *
+    {
+        return nullptr;
+    }
+
+    // Runs on the audio thread; must neither allocate nor block.
+    virtual auto Render(InputsType pInputs, OutputsType pOutputs, SizeType pSampleCount) -> void = 0;
+};
+
+template <>
+AudioNode<>::~AudioNode() {}
+
+#endif // AUDIO_NODE_HPP
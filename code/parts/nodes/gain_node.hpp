@@ -0,0 +1,28 @@
+#ifndef GAIN_NODE_HPP
+#define GAIN_NODE_HPP
+
+#include "audio_node.hpp"
+
+// Scales its input by `gain`.
+template <class = void>
+class GainNode final : public AudioNode<>
+{
+public:
+    ValueType gain;
+
+    explicit GainNode(ValueType pGain = 1.0f) : gain(pGain) {}
+    ~GainNode() override = default;
+
+    auto ViewInputCount() const -> SizeType override { return 1; }
+    auto ViewOutputCount() const -> SizeType override { return 1; }
+
+    auto Render(InputsType pInputs, OutputsType pOutputs, SizeType pSampleCount) -> void override
+    {
+        const auto *input = pInputs[0];
+        auto *output = pOutputs[0];
+        for (SizeType i = 0; i < pSampleCount; i++)
+            output[i] = input[i] * gain;
+    }
+};
+
+#endif // GAIN_NODE_HPP
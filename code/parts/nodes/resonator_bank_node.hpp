@@ -0,0 +1,35 @@
+#ifndef RESONATOR_BANK_NODE_HPP
+#define RESONATOR_BANK_NODE_HPP
+
+#include "audio_node.hpp"
+#include "parts/resonator_bank.hpp"
+
+// Excites a ResonatorBank owned elsewhere with its input; the bank's output is read in place.
+template <class = void>
+class ResonatorBankNode final : public AudioNode<>
+{
+public:
+    using ResonatorBankType = ResonatorBank<>;
+
+private:
+    ResonatorBankType &resonators;
+
+public:
+    explicit ResonatorBankNode(ResonatorBankType &pResonators) : resonators(pResonators) {}
+    ~ResonatorBankNode() override = default;
+
+    auto ViewInputCount() const -> SizeType override { return 1; }
+    auto ViewOutputCount() const -> SizeType override { return 1; }
+
+    auto ViewOwnedOutput(SizeType) const -> const ValueType * override
+    {
+        return resonators.ViewOutput().data();
+    }
+
+    auto Render(InputsType pInputs, OutputsType, SizeType pSampleCount) -> void override
+    {
+        resonators.Render(ResonatorBankType::SamplesViewType(pInputs[0], pSampleCount), pSampleCount);
+    }
+};
+
+#endif // RESONATOR_BANK_NODE_HPP
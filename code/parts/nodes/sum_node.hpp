@@ -0,0 +1,32 @@
+#ifndef SUM_NODE_HPP
+#define SUM_NODE_HPP
+
+#include <algorithm>
+
+#include "audio_node.hpp"
+
+// Adds its inputs, in port order.
+template <class = void>
+class SumNode final : public AudioNode<>
+{
+private:
+    SizeType inputCount;
+
+public:
+    explicit SumNode(SizeType pInputCount) : inputCount(pInputCount) {}
+    ~SumNode() override = default;
+
+    auto ViewInputCount() const -> SizeType override { return inputCount; }
+    auto ViewOutputCount() const -> SizeType override { return 1; }
+
+    auto Render(InputsType pInputs, OutputsType pOutputs, SizeType pSampleCount) -> void override
+    {
+        auto *output = pOutputs[0];
+        std::fill(output, output + pSampleCount, 0.0f);
+        for (const auto *input : pInputs)
+            for (SizeType i = 0; i < pSampleCount; i++)
+                output[i] += input[i];
+    }
+};
+
+#endif // SUM_NODE_HPP
@@ -0,0 +1,35 @@
+#ifndef VOICE_BANK_NODE_HPP
+#define VOICE_BANK_NODE_HPP
+
+#include "audio_node.hpp"
+#include "parts/voice_bank.hpp"
+
+// Renders a VoiceBank owned elsewhere; its mix is the node's only output, read in place.
+template <class TVoiceBankType = VoiceBank<>>
+class VoiceBankNode final : public AudioNode<>
+{
+public:
+    using VoiceBankType = TVoiceBankType;
+
+private:
+    VoiceBankType &voices;
+
+public:
+    explicit VoiceBankNode(VoiceBankType &pVoices) : voices(pVoices) {}
+    ~VoiceBankNode() override = default;
+
+    auto ViewInputCount() const -> SizeType override { return 0; }
+    auto ViewOutputCount() const -> SizeType override { return 1; }
+
+    auto ViewOwnedOutput(SizeType) const -> const ValueType * override
+    {
+        return voices.ViewMix().data();
+    }
+
+    auto Render(InputsType, OutputsType, SizeType pSampleCount) -> void override
+    {
+        voices.Render(pSampleCount);
+    }
+};
+
+#endif // VOICE_BANK_NODE_HPP
@@ -0,0 +1,154 @@
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <raylib.h>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+#include "utilities/sample_ring.hpp"
+#include "utilities/wave_file.hpp"
+
+// Records the device output to a 32-bit float WAV (or .raw) file in the background.
+// The audio thread only copies each block into a ring preallocated for BUFFER_DURATION seconds; a writer thread
+// wakes every WRITE_INTERVAL, drains the ring in chunks of up to WRITE_CHUNK_SIZE samples and appends them to the file.
+// 16-bit output is widened to float on the way in, which is exact, so the file holds precisely what was played.
+// Blocks that find the ring full are dropped, not waited for, and counted.
+template <class = void>
+class Recorder final : public Part<>
+{
+public:
+    using SampleType = float;
+    using RingType = SampleRing<SampleType>;
+    using FileType = WaveFile<SampleType>;
+    using SamplesType = std::vector<SampleType>;
+
+    static constexpr const FloatType BUFFER_DURATION = 2.0;
+    static constexpr const auto WRITE_INTERVAL = std::chrono::milliseconds(20);
+    static constexpr const SizeType WRITE_CHUNK_SIZE = 1 << 16;
+    static constexpr const SampleType PCM_SCALE = 1.0f / 32768.0f;
+
+private:
+    Settings settings;
+    RingType ring;
+    // Audio thread only.
+    SamplesType scratch;
+    // Writer thread only while recording.
+    SamplesType chunk;
+    std::unique_ptr<FileType> file;
+    std::string path;
+    std::atomic<BoolType> recording;
+    std::atomic<SizeType> droppedSampleCount;
+    std::jthread writer;
+
+    auto drain() -> void
+    {
+        while (const auto count = ring.Read(chunk.data(), chunk.size()))
+            file->Write(chunk.data(), count);
+    }
+
+    auto write(std::stop_token pStopToken) -> void
+    {
+        while (!pStopToken.stop_requested())
+        {
+            drain();
+            std::this_thread::sleep_for(WRITE_INTERVAL);
+        }
+        drain();
+    }
+
+    auto push(const SampleType *pSamples, SizeType pSampleCount) -> void
+    {
+        const auto writtenCount = ring.Write(pSamples, pSampleCount);
+        if (writtenCount < pSampleCount)
+            droppedSampleCount.fetch_add(pSampleCount - writtenCount, std::memory_order_relaxed);
+    }
+
+public:
+    explicit Recorder(const Settings &pSettings)
+        : settings(pSettings),
+          ring(SizeType(BUFFER_DURATION * pSettings.sampleRate)),
+          scratch(pSettings.blockSize),
+          chunk(WRITE_CHUNK_SIZE),
+          file(),
+          path(),
+          recording(false),
+          droppedSampleCount(0),
+          writer() {}
+    Recorder(const Recorder &) = delete;
+    auto operator=(const Recorder &) -> Recorder & = delete;
+    ~Recorder() override { Stop(); }
+
+    auto IsRecording() const -> BoolType { return recording.load(std::memory_order_acquire); }
+    auto ViewDroppedSampleCount() const -> SizeType { return droppedSampleCount.load(std::memory_order_relaxed); }
+
+    // UI thread; opens pPath and starts the writer. Returns false if already recording or the file cannot be opened.
+    auto Start(const std::string &pPath) -> BoolType
+    {
+        if (IsRecording())
+            return false;
+        file = std::make_unique<FileType>(pPath, settings.sampleRate);
+        if (!file->IsOpen())
+        {
+            TraceLog(LOG_WARNING, "Could not open recording %s.", pPath.c_str());
+            file.reset();
+            return false;
+        }
+        path = pPath;
+        ring.Discard();
+        droppedSampleCount.store(0, std::memory_order_relaxed);
+        writer = std::jthread([this](std::stop_token pStopToken)
+                              { write(pStopToken); });
+        recording.store(true, std::memory_order_release);
+        TraceLog(LOG_INFO, "Recording to %s.", pPath.c_str());
+        return true;
+    }
+
+    // UI thread; blocks already pushed are still written before the file is closed.
+    auto Stop() -> void
+    {
+        if (!IsRecording())
+            return;
+        recording.store(false, std::memory_order_release);
+        writer.request_stop();
+        writer.join();
+        file->Close();
+        TraceLog(LOG_INFO, "Recorded %.2f s to %s; %zu samples dropped.",
+                 FloatType(file->ViewSampleCount()) / settings.sampleRate, path.c_str(), ViewDroppedSampleCount());
+        file.reset();
+    }
+
+    // Audio thread; never allocates, blocks or touches the file system.
+    auto Record(const SampleType *pSamples, SizeType pSampleCount) -> void
+    {
+        if (IsRecording())
+            push(pSamples, pSampleCount);
+    }
+
+    auto Record(const short *pSamples, SizeType pSampleCount) -> void
+    {
+        if (!IsRecording())
+            return;
+        for (SizeType offset = 0; offset < pSampleCount; offset += scratch.size())
+        {
+            const auto sampleCount = std::min(scratch.size(), pSampleCount - offset);
+            for (SizeType i = 0; i < sampleCount; i++)
+                scratch[i] = SampleType(pSamples[offset + i]) * PCM_SCALE;
+            push(scratch.data(), sampleCount);
+        }
+    }
+
+    auto Finish() -> void override
+    {
+        Stop();
+    }
+};
+
+#endif // RECORDER_HPP
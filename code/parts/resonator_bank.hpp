@@ -0,0 +1,177 @@
+#ifndef RESONATOR_BANK_HPP
+#define RESONATOR_BANK_HPP
+
+#include <vector>
+#include <span>
+#include <cmath>
+#include <algorithm>
+#include <numbers>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+#include "voice_state.hpp"
+#include "utilities/simd.hpp"
+#include "utilities/aligned_allocator.hpp"
+
+// Bank of two-pole modal resonators, all excited by the same input signal and summed into one output.
+// Each mode rings at its frequency and decays by 60 dB over its decay time; its peak gain is normalised to `gain`,
+// so an input sine right on the mode comes out at `gain` times its amplitude once the mode has built up.
+//
+// Modes are stored as structure of arrays and evaluated FloatLanes::COUNT modes per instruction.
+// The recursion runs a whole block per group of lanes, so the filter state stays in registers, and every
+// mode's output is kept in `frames` until the next block, which is what the views draw from.
+// Once the input is silent and every mode has decayed below RESTING_AMPLITUDE the bank rests and costs nothing.
+template <class = void>
+class ResonatorBank final : public Part<>
+{
+public:
+    using ValueType = float;
+    using LanesType = FloatLanes;
+    using ArrayType = std::vector<ValueType, AlignedAllocator<ValueType, LanesType::ALIGNMENT>>;
+    using SamplesViewType = std::span<const ValueType>;
+
+    struct ModeType
+    {
+        FloatType frequency;
+        // Seconds to fall by 60 dB.
+        FloatType decayTime;
+        FloatType gain;
+    };
+    using ModesViewType = std::span<const ModeType>;
+
+    // Modes at or above this fraction of the sample rate are left silent.
+    static constexpr const FloatType MAX_FREQUENCY_RATIO = 0.45;
+    static constexpr const ValueType RESTING_AMPLITUDE = ValueType(SILENT_AMPLITUDE * 0.01);
+
+private:
+    Settings settings;
+    SizeType modeCount;
+    SizeType modeStride;
+    SizeType blockStride;
+
+    // One aligned arena holds the coefficients and state of every mode, the per-mode frames and the output.
+    ArrayType arena;
+    ValueType *gains;
+    ValueType *feedbacks;
+    ValueType *dampings;
+    ValueType *previousOutputs;
+    ValueType *olderOutputs;
+    ValueType *frames;
+    ValueType *output;
+
+    BoolType resting;
+
+    static auto computeStride(SizeType pCount) -> SizeType
+    {
+        const auto alignmentCount = LanesType::ALIGNMENT / sizeof(ValueType);
+        return (pCount + alignmentCount - 1) / alignmentCount * alignmentCount;
+    }
+
+    auto rest(SizeType pSampleCount) -> void
+    {
+        std::fill(previousOutputs, previousOutputs + modeStride, 0.0f);
+        std::fill(olderOutputs, olderOutputs + modeStride, 0.0f);
+        std::fill(frames, frames + modeStride * blockStride, 0.0f);
+        std::fill(output, output + pSampleCount, 0.0f);
+        resting = true;
+    }
+
+public:
+    // y[n] = gain' * x[n] + 2r cos(w) * y[n - 1] - r^2 * y[n - 2], with r from the decay time and gain' normalising the peak to `gain`.
+    ResonatorBank(const Settings &pSettings, ModesViewType pModes)
+        : settings(pSettings),
+          modeCount(pModes.size()),
+          modeStride(computeStride(pModes.size())),
+          blockStride(computeStride(pSettings.blockSize)),
+          arena(modeStride * 5 + modeStride * blockStride + blockStride, 0.0f),
+          gains(arena.data()),
+          feedbacks(gains + modeStride),
+          dampings(feedbacks + modeStride),
+          previousOutputs(dampings + modeStride),
+          olderOutputs(previousOutputs + modeStride),
+          frames(olderOutputs + modeStride),
+          output(frames + modeStride * blockStride),
+          resting(true)
+    {
+        for (SizeType mode = 0; mode < modeCount; mode++)
+        {
+            const auto &parameters = pModes[mode];
+            if (parameters.frequency <= 0.0 || parameters.frequency >= pSettings.sampleRate * MAX_FREQUENCY_RATIO || parameters.decayTime <= 0.0)
+                continue;
+            const auto angle = 2.0 * std::numbers::pi * parameters.frequency / pSettings.sampleRate;
+            const auto radius = std::exp(-std::log(1000.0) / (parameters.decayTime * pSettings.sampleRate));
+            gains[mode] = ValueType(parameters.gain * (1.0 - radius) * std::sqrt(1.0 - 2.0 * radius * std::cos(2.0 * angle) + radius * radius));
+            feedbacks[mode] = ValueType(2.0 * radius * std::cos(angle));
+            dampings[mode] = ValueType(-radius * radius);
+        }
+    }
+    ResonatorBank(const ResonatorBank &) = delete;
+    auto operator=(const ResonatorBank &) -> ResonatorBank & = delete;
+    ~ResonatorBank() override = default;
+
+    auto ViewModeCount() const -> SizeType { return modeCount; }
+    auto IsResting() const -> BoolType { return resting; }
+
+    // Output of pMode at pSample of the latest block.
+    auto ViewModeSample(SizeType pMode, SizeType pSample) const -> ValueType
+    {
+        const auto group = pMode / LanesType::COUNT;
+        return frames[(group * blockStride + pSample) * LanesType::COUNT + pMode % LanesType::COUNT];
+    }
+
+    auto ViewOutput() const -> SamplesViewType
+    {
+        return SamplesViewType(output, settings.blockSize);
+    }
+
+    auto Render(SamplesViewType pInput, SizeType pSampleCount) -> void
+    {
+        const auto sampleCount = std::min({pSampleCount, pInput.size(), settings.blockSize});
+        const auto silent = std::all_of(pInput.begin(), pInput.begin() + sampleCount, [](ValueType pValue)
+                                        { return pValue == 0.0f; });
+        if (resting && silent)
+        {
+            std::fill(output, output + sampleCount, 0.0f);
+            return;
+        }
+        resting = false;
+
+        const auto groupCount = modeStride / LanesType::COUNT;
+        for (SizeType group = 0; group < groupCount; group++)
+        {
+            const auto offset = group * LanesType::COUNT;
+            const auto gain = LanesType::Load(gains + offset);
+            const auto feedback = LanesType::Load(feedbacks + offset);
+            const auto damping = LanesType::Load(dampings + offset);
+            auto previous = LanesType::Load(previousOutputs + offset);
+            auto older = LanesType::Load(olderOutputs + offset);
+            auto *groupFrames = frames + group * blockStride * LanesType::COUNT;
+            for (SizeType i = 0; i < sampleCount; i++)
+            {
+                const auto value = gain * LanesType::Broadcast(pInput[i]) + feedback * previous + damping * older;
+                value.Store(groupFrames + i * LanesType::COUNT);
+                older = previous;
+                previous = value;
+            }
+            previous.Store(previousOutputs + offset);
+            older.Store(olderOutputs + offset);
+        }
+
+        for (SizeType i = 0; i < sampleCount; i++)
+        {
+            auto sum = LanesType::Broadcast(0.0f);
+            for (SizeType group = 0; group < groupCount; group++)
+                sum = sum + LanesType::Load(frames + (group * blockStride + i) * LanesType::COUNT);
+            output[i] = sum.Sum();
+        }
+
+        auto peak = 0.0f;
+        for (SizeType mode = 0; mode < modeStride; mode++)
+            peak = std::max({peak, std::abs(previousOutputs[mode]), std::abs(olderOutputs[mode])});
+        if (silent && peak < RESTING_AMPLITUDE)
+            rest(sampleCount);
+    }
+};
+
+#endif // RESONATOR_BANK_HPP
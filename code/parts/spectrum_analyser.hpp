@@ -0,0 +1,149 @@
+#ifndef SPECTRUM_ANALYSER_HPP
+#define SPECTRUM_ANALYSER_HPP
+
+#include <span>
+#include <atomic>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+#include "utilities/real_fft.hpp"
+#include "utilities/sample_ring.hpp"
+
+// Spectrum of a signal rendered on the audio thread, analysed on the UI thread.
+// While enabled, the audio thread only copies each block into a ring preallocated for BUFFER_DURATION seconds.
+// Process(), on the UI thread, drains the ring and runs one Hann-windowed FFT_SIZE transform every HOP_SIZE samples,
+// so windows overlap by three quarters and the spectrum advances as blocks arrive, whatever the frame rate.
+// Levels are in decibels relative to a full-scale sine; they rise at once and fall by at most FALL_RATE per second.
+template <class = void>
+class SpectrumAnalyser final : public Part<>
+{
+public:
+    using ValueType = RealFft::ValueType;
+    using ArrayType = RealFft::ArrayType;
+    using RingType = SampleRing<ValueType>;
+    using LevelsViewType = std::span<const ValueType>;
+
+    static constexpr const SizeType FFT_SIZE = 4096;
+    static constexpr const SizeType HOP_SIZE = FFT_SIZE / 4;
+    static constexpr const FloatType BUFFER_DURATION = 0.5;
+    static constexpr const ValueType MIN_DECIBELS = -120.0f;
+    // Decibels per second.
+    static constexpr const FloatType FALL_RATE = 60.0;
+
+private:
+    Settings settings;
+    RingType ring;
+    std::atomic<BoolType> enabled;
+
+    // UI thread only.
+    RealFft fft;
+    ArrayType window;
+    ArrayType history;
+    ArrayType frame;
+    ArrayType reals;
+    ArrayType imaginaries;
+    ArrayType levels;
+    // Samples in `history`; a transform runs whenever it reaches FFT_SIZE.
+    SizeType historySize;
+    ValueType magnitudeScale;
+    ValueType fallPerHop;
+    SizeType transformCount;
+
+    auto analyse() -> void
+    {
+        for (SizeType i = 0; i < FFT_SIZE; i++)
+            frame[i] = history[i] * window[i];
+        fft.Transform(frame.data(), reals.data(), imaginaries.data());
+        for (SizeType bin = 0; bin < levels.size(); bin++)
+        {
+            const auto power = reals[bin] * reals[bin] + imaginaries[bin] * imaginaries[bin];
+            const auto decibels = std::max(10.0f * std::log10(power * magnitudeScale * magnitudeScale + 1e-30f), MIN_DECIBELS);
+            levels[bin] = std::max(decibels, levels[bin] - fallPerHop);
+        }
+        transformCount++;
+    }
+
+public:
+    // pFullScale is the amplitude of the signal that reaches full scale at the output.
+    SpectrumAnalyser(const Settings &pSettings, FloatType pFullScale)
+        : settings(pSettings),
+          ring(SizeType(BUFFER_DURATION * pSettings.sampleRate)),
+          enabled(false),
+          fft(FFT_SIZE),
+          window(FFT_SIZE, 0.0f),
+          history(FFT_SIZE, 0.0f),
+          frame(FFT_SIZE, 0.0f),
+          reals(fft.ViewBinCount(), 0.0f),
+          imaginaries(fft.ViewBinCount(), 0.0f),
+          levels(fft.ViewBinCount(), MIN_DECIBELS),
+          historySize(FFT_SIZE - HOP_SIZE),
+          magnitudeScale(0.0f),
+          fallPerHop(ValueType(FALL_RATE * HOP_SIZE / pSettings.sampleRate)),
+          transformCount(0)
+    {
+        auto windowSum = 0.0;
+        for (SizeType i = 0; i < FFT_SIZE; i++)
+        {
+            window[i] = ValueType(0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * FloatType(i) / FloatType(FFT_SIZE)));
+            windowSum += window[i];
+        }
+        // A sine at a bin's centre comes out at amplitude * windowSum / 2.
+        magnitudeScale = ValueType(2.0 / (windowSum * pFullScale));
+    }
+    SpectrumAnalyser(const SpectrumAnalyser &) = delete;
+    auto operator=(const SpectrumAnalyser &) -> SpectrumAnalyser & = delete;
+    ~SpectrumAnalyser() override = default;
+
+    auto IsEnabled() const -> BoolType { return enabled.load(std::memory_order_acquire); }
+    auto ViewBinCount() const -> SizeType { return levels.size(); }
+    auto ViewBinFrequency(SizeType pBin) const -> FloatType { return FloatType(pBin) * settings.sampleRate / FFT_SIZE; }
+    auto ViewLevels() const -> LevelsViewType { return levels; }
+    auto ViewTransformCount() const -> SizeType { return transformCount; }
+
+    // UI thread; starts from silence.
+    auto Enable() -> void
+    {
+        if (IsEnabled())
+            return;
+        ring.Discard();
+        std::fill(history.begin(), history.end(), 0.0f);
+        std::fill(levels.begin(), levels.end(), MIN_DECIBELS);
+        historySize = FFT_SIZE - HOP_SIZE;
+        enabled.store(true, std::memory_order_release);
+    }
+
+    // UI thread.
+    auto Disable() -> void
+    {
+        enabled.store(false, std::memory_order_release);
+    }
+
+    // Audio thread; only copies, and drops what does not fit while the UI thread falls behind.
+    auto Push(const ValueType *pSamples, SizeType pSampleCount) -> void
+    {
+        if (IsEnabled())
+            ring.Write(pSamples, pSampleCount);
+    }
+
+    // UI thread; runs one transform per complete hop that has arrived since the last call.
+    auto Process() -> void override
+    {
+        if (!IsEnabled())
+            return;
+        while (true)
+        {
+            historySize += ring.Read(history.data() + historySize, FFT_SIZE - historySize);
+            if (historySize < FFT_SIZE)
+                break;
+            analyse();
+            std::copy(history.begin() + HOP_SIZE, history.end(), history.begin());
+            historySize -= HOP_SIZE;
+        }
+    }
+};
+
+#endif // SPECTRUM_ANALYSER_HPP
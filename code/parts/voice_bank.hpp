@@ -0,0 +1,522 @@
+#ifndef VOICE_BANK_HPP
+#define VOICE_BANK_HPP
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <concepts>
+#include <type_traits>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <numbers>
+#include <cstdint>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "part.hpp"
+#include "voice_state.hpp"
+#include "waveforms/waveform.hpp"
+#include "waveforms/sine_waveform.hpp"
+#include "utilities/simd.hpp"
+#include "utilities/aligned_allocator.hpp"
+#include "utilities/worker_pool.hpp"
+
+// Fixed-capacity pool of voices, stored as structure of arrays and rendered together in float32.
+// Notes are numbered 0 to the note count; a voice is bound to a note when the note starts sounding and returns to the
+// pool once its release has faded out. When every voice is busy the quietest one is stolen, so all storage is
+// allocated once, in the constructor, and the audio path never allocates.
+// Each voice is rendered FloatLanes::COUNT samples per instruction into its own row of `samples`, and summed into `mix`.
+// Only voices that are not idle are visited, so the cost follows the number of sounding voices, not the number of notes.
+// With Settings::workerCount workers, large blocks are spread across threads (see Render).
+// Amplitudes follow their targets with per-sample one-pole smoothing, evaluated in closed form FloatLanes::COUNT samples at a time.
+//
+// A note can sound as a unison stack of up to MAX_UNISON_COUNT detuned copies (see SetNoteUnison), still in one voice.
+// The stack is written as a carrier at the note's pitch times a slowly turning complex envelope, the sum of one
+// unit rotor per copy spinning at that copy's detune: sum_k sin(p + d_k) = sin(p) Re(E) + cos(p) Im(E).
+// The rotors are advanced, FloatLanes::COUNT copies at once, only once per group of samples and the envelope is
+// interpolated in between, so a stack costs two sines per sample plus a few operations per group, whatever its size.
+// That identity only holds for a sine; with any other waveform every copy is evaluated on its own.
+//
+// Every voice plays TWaveformType (see Waveform): a concrete waveform is stored inline and dispatched statically,
+// while the abstract Waveform takes any waveform at construction and calls it virtually.
+template <class TWaveformType = SineWaveform>
+    requires std::derived_from<TWaveformType, Waveform>
+class VoiceBank final : public Part<>
+{
+public:
+    using WaveformType = TWaveformType;
+    static constexpr const BoolType POLYMORPHIC = std::is_abstract_v<WaveformType>;
+    using WaveformLeashType = std::conditional_t<POLYMORPHIC, std::unique_ptr<WaveformType>, WaveformType>;
+    using ValueType = float;
+    using LanesType = FloatLanes;
+    using ArrayType = std::vector<ValueType, AlignedAllocator<ValueType, LanesType::ALIGNMENT>>;
+    using SamplesViewType = std::span<const ValueType>;
+    using FrequenciesViewType = std::span<const FloatType>;
+    using StatesType = std::vector<VoiceState>;
+    using IndicesType = std::vector<SizeType>;
+
+    struct UnisonType
+    {
+        // Copies of the note, 1 to MAX_UNISON_COUNT.
+        SizeType count;
+        // Cents between the lowest and the highest copy.
+        FloatType spread;
+        // Start every copy at a random phase instead of all at zero.
+        BoolType randomPhases;
+    };
+    using UnisonsType = std::vector<UnisonType>;
+
+    // Milliseconds. Targets arrive as steps, at most once per control step, and the mouse speed behind them only
+    // glides linearly between frames, so the rise is slow enough to round those corners into a swell; a released note
+    // at an amplitude of 5000 takes about two seconds to fall below SILENT_AMPLITUDE.
+    static constexpr const FloatType AMPLITUDE_RISE_TIME = 50.0;
+    static constexpr const FloatType AMPLITUDE_FALL_TIME = 200.0;
+    static constexpr const SizeType NO_VOICE = std::numeric_limits<SizeType>::max();
+    static constexpr const SizeType NO_NOTE = std::numeric_limits<SizeType>::max();
+    // Below this many voice-samples per block, handing work to other threads costs more than it saves.
+    static constexpr const SizeType MIN_PARALLEL_SAMPLE_COUNT = 4096;
+    static constexpr const SizeType MIX_TASK_SAMPLE_COUNT = 64;
+    static constexpr const SizeType UNISON_STRIDE = (MAX_UNISON_COUNT + LanesType::COUNT - 1) / LanesType::COUNT * LanesType::COUNT;
+
+private:
+    Settings settings;
+    WaveformLeashType waveform;
+    SizeType voiceCapacity;
+    SizeType blockStride;
+    SizeType voiceStride;
+
+    // One aligned arena holds every per-voice array, a sample row per voice plus a silent row, and the mix.
+    ArrayType arena;
+    ValueType *phases;
+    ValueType *increments;
+    ValueType *amplitudes;
+    ValueType *amplitudeTargets;
+    ValueType *samples;
+    ValueType *mix;
+    // UNISON_STRIDE entries per voice: each copy's phase offset from the carrier in cycles, its detune in cycles
+    // per sample, and its rotor's turn over one group of FloatLanes::COUNT samples.
+    ValueType *unisonPhases;
+    ValueType *unisonIncrements;
+    ValueType *unisonStepReals;
+    ValueType *unisonStepImaginaries;
+
+    StatesType states;
+    IndicesType activeVoices;
+    IndicesType freeVoices;
+    IndicesType voiceNotes;
+    IndicesType noteVoices;
+    ArrayType noteIncrements;
+    // Pitch ratio applied on top of each note's increment.
+    ArrayType noteBends;
+    IndicesType unisonCounts;
+    UnisonsType noteUnisons;
+    std::uint32_t unisonSeed;
+
+    // Per-sample retention r of the rising and falling one-pole, its lane powers r, r^2, ..., r^COUNT,
+    // and r^COUNT on its own to step from one chunk of lanes to the next.
+    FloatType riseRetention;
+    FloatType fallRetention;
+    ArrayType risePowers;
+    ArrayType fallPowers;
+
+    // Voice-samples per block below which Render stays on the calling thread; MIN_PARALLEL_SAMPLE_COUNT by default.
+    SizeType minParallelSampleCount;
+    WorkerPool workers;
+
+    static auto computePowers(FloatType pRetention) -> ArrayType
+    {
+        auto powers = ArrayType(LanesType::COUNT, 0.0f);
+        auto power = 1.0;
+        for (auto &lanePower : powers)
+            lanePower = ValueType(power *= pRetention);
+        return powers;
+    }
+
+    // Fraction of the remaining distance kept after one sample, for a time constant in milliseconds.
+    static auto computeRetention(FloatType pTime, FloatType pSampleRate) -> FloatType
+    {
+        return pTime > 0.0 ? std::exp(-1000.0 / (pTime * pSampleRate)) : 0.0;
+    }
+
+    static auto computeStride(SizeType pCount) -> SizeType
+    {
+        const auto alignmentCount = LanesType::ALIGNMENT / sizeof(ValueType);
+        return (pCount + alignmentCount - 1) / alignmentCount * alignmentCount;
+    }
+
+    // Prefers a free voice; otherwise steals the quietest sounding one from its note.
+    auto acquireVoice() -> SizeType
+    {
+        if (!freeVoices.empty())
+        {
+            const auto voice = freeVoices.back();
+            freeVoices.pop_back();
+            phases[voice] = 0.0f;
+            amplitudes[voice] = 0.0f;
+            activeVoices.push_back(voice);
+            return voice;
+        }
+
+        auto voice = activeVoices.front();
+        for (const auto activeVoice : activeVoices)
+            if (amplitudes[activeVoice] < amplitudes[voice])
+                voice = activeVoice;
+        noteVoices[voiceNotes[voice]] = NO_VOICE;
+        return voice;
+    }
+
+    // xorshift32, uniform in [0, 1); deterministic so offline renders stay reproducible.
+    auto nextUniform() -> ValueType
+    {
+        unisonSeed ^= unisonSeed << 13;
+        unisonSeed ^= unisonSeed >> 17;
+        unisonSeed ^= unisonSeed << 5;
+        return ValueType(unisonSeed >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // Lays the note's unison stack out on the voice; unused copies get a zero step so they stay silent.
+    auto bindUnison(SizeType pVoice, SizeType pNote) -> void
+    {
+        const auto &unison = noteUnisons[pNote];
+        const auto count = std::clamp(unison.count, SizeType(1), MAX_UNISON_COUNT);
+        unisonCounts[pVoice] = count;
+        const auto increment = FloatType(noteIncrements[pNote]);
+        for (SizeType copy = 0; copy < UNISON_STRIDE; copy++)
+        {
+            const auto index = pVoice * UNISON_STRIDE + copy;
+            const auto used = copy < count;
+            const auto cents = count > 1 ? unison.spread * (FloatType(copy) / (count - 1) - 0.5) : 0.0;
+            const auto detune = used ? increment * (std::exp2(cents / 1200.0) - 1.0) : 0.0;
+            const auto stepAngle = 2.0 * std::numbers::pi * detune * LanesType::COUNT;
+            unisonPhases[index] = used && unison.randomPhases ? nextUniform() : 0.0f;
+            unisonIncrements[index] = ValueType(detune);
+            unisonStepReals[index] = used ? ValueType(std::cos(stepAngle)) : 0.0f;
+            unisonStepImaginaries[index] = used ? ValueType(std::sin(stepAngle)) : 0.0f;
+        }
+    }
+
+    // Renders one voice into its row, and also adds it into the mix when TAccumulate is set.
+    // With TUnison the carrier is multiplied by the voice's unison envelope (see the class comment).
+    template <BoolType TAccumulate, BoolType TUnison>
+    auto renderVoice(SizeType pVoice, SizeType pSampleCount) -> void
+    {
+        const auto chunkCount = (pSampleCount + LanesType::COUNT - 1) / LanesType::COUNT;
+        const auto increment = increments[pVoice];
+        const auto amplitudeTarget = amplitudeTargets[pVoice];
+        const auto startDifference = amplitudes[pVoice] - amplitudeTarget;
+        const auto falling = startDifference > 0.0f;
+        const auto retention = falling ? fallRetention : riseRetention;
+        const auto powers = LanesType::Load(falling ? fallPowers.data() : risePowers.data());
+        const auto chunkRetention = ValueType(falling ? fallPowers.back() : risePowers.back());
+        const auto target = LanesType::Broadcast(amplitudeTarget);
+        const auto &shape = ViewWaveform();
+        const auto band = shape.SelectBand(increment);
+
+        // Rotors start from the copies' phases, scaled so the copies add up in power rather than in amplitude.
+        alignas(LanesType::ALIGNMENT) ValueType rotorReals[UNISON_STRIDE];
+        alignas(LanesType::ALIGNMENT) ValueType rotorImaginaries[UNISON_STRIDE];
+        auto envelopeReal = 0.0f;
+        auto envelopeImaginary = 0.0f;
+        const auto *stepReals = unisonStepReals + pVoice * UNISON_STRIDE;
+        const auto *stepImaginaries = unisonStepImaginaries + pVoice * UNISON_STRIDE;
+        // Without the rotor form, each copy's offset from the carrier phase at the start of the current group.
+        alignas(LanesType::ALIGNMENT) ValueType copyPhases[UNISON_STRIDE];
+        const auto *copyIncrements = unisonIncrements + pVoice * UNISON_STRIDE;
+        const auto copyGain = LanesType::Broadcast(ValueType(1.0 / std::sqrt(FloatType(unisonCounts[pVoice]))));
+        if constexpr (TUnison && !WaveformType::SINUSOIDAL)
+            std::copy(unisonPhases + pVoice * UNISON_STRIDE, unisonPhases + (pVoice + 1) * UNISON_STRIDE, copyPhases);
+        if constexpr (TUnison && WaveformType::SINUSOIDAL)
+        {
+            const auto gain = 1.0 / std::sqrt(FloatType(unisonCounts[pVoice]));
+            for (SizeType copy = 0; copy < UNISON_STRIDE; copy++)
+            {
+                const auto angle = 2.0 * std::numbers::pi * unisonPhases[pVoice * UNISON_STRIDE + copy];
+                const auto used = copy < unisonCounts[pVoice];
+                rotorReals[copy] = used ? ValueType(gain * std::cos(angle)) : 0.0f;
+                rotorImaginaries[copy] = used ? ValueType(gain * std::sin(angle)) : 0.0f;
+                envelopeReal += rotorReals[copy];
+                envelopeImaginary += rotorImaginaries[copy];
+            }
+        }
+        const auto interpolation = LanesType::Ramp(0.0f, 1.0f / LanesType::COUNT);
+        const auto quarter = LanesType::Broadcast(0.25f);
+
+        auto *voiceSamples = samples + pVoice * blockStride;
+        auto chunkPhase = phases[pVoice];
+        auto chunkDifference = startDifference;
+        const auto chunkIncrement = increment * LanesType::COUNT;
+        for (SizeType chunk = 0; chunk < chunkCount; chunk++)
+        {
+            const auto offset = chunk * LanesType::COUNT;
+            const auto phase = LanesType::Ramp(chunkPhase, increment).Fraction();
+            const auto amplitude = target + LanesType::Broadcast(chunkDifference) * powers;
+            auto value = shape.Evaluate(phase, band) * amplitude;
+            if constexpr (TUnison && !WaveformType::SINUSOIDAL)
+            {
+                auto sum = LanesType::Broadcast(0.0f);
+                for (SizeType copy = 0; copy < unisonCounts[pVoice]; copy++)
+                {
+                    sum = sum + shape.Evaluate(LanesType::Ramp(chunkPhase + copyPhases[copy], increment + copyIncrements[copy]).Fraction(), band);
+                    copyPhases[copy] += copyIncrements[copy] * LanesType::COUNT;
+                    copyPhases[copy] -= std::floor(copyPhases[copy]);
+                }
+                value = sum * copyGain * amplitude;
+            }
+            if constexpr (TUnison && WaveformType::SINUSOIDAL)
+            {
+                auto nextReal = LanesType::Broadcast(0.0f);
+                auto nextImaginary = LanesType::Broadcast(0.0f);
+                for (SizeType copy = 0; copy < UNISON_STRIDE; copy += LanesType::COUNT)
+                {
+                    const auto real = LanesType::Load(rotorReals + copy);
+                    const auto imaginary = LanesType::Load(rotorImaginaries + copy);
+                    const auto stepReal = LanesType::Load(stepReals + copy);
+                    const auto stepImaginary = LanesType::Load(stepImaginaries + copy);
+                    const auto turnedReal = real * stepReal - imaginary * stepImaginary;
+                    const auto turnedImaginary = real * stepImaginary + imaginary * stepReal;
+                    turnedReal.Store(rotorReals + copy);
+                    turnedImaginary.Store(rotorImaginaries + copy);
+                    nextReal = nextReal + turnedReal;
+                    nextImaginary = nextImaginary + turnedImaginary;
+                }
+                const auto nextEnvelopeReal = nextReal.Sum();
+                const auto nextEnvelopeImaginary = nextImaginary.Sum();
+                const auto real = LanesType::Broadcast(envelopeReal) + LanesType::Broadcast(nextEnvelopeReal - envelopeReal) * interpolation;
+                const auto imaginary = LanesType::Broadcast(envelopeImaginary) + LanesType::Broadcast(nextEnvelopeImaginary - envelopeImaginary) * interpolation;
+                value = (LanesType::Sine(phase) * real + LanesType::Sine((phase + quarter).Fraction()) * imaginary) * amplitude;
+                envelopeReal = nextEnvelopeReal;
+                envelopeImaginary = nextEnvelopeImaginary;
+            }
+            value.Store(voiceSamples + offset);
+            if constexpr (TAccumulate)
+                (LanesType::Load(mix + offset) + value).Store(mix + offset);
+
+            chunkPhase += chunkIncrement;
+            chunkPhase -= std::floor(chunkPhase);
+            chunkDifference *= chunkRetention;
+        }
+
+        const auto phase = FloatType(phases[pVoice]) + FloatType(increment) * pSampleCount;
+        phases[pVoice] = ValueType(phase - std::floor(phase));
+        if constexpr (TUnison)
+            for (SizeType copy = 0; copy < unisonCounts[pVoice]; copy++)
+            {
+                const auto index = pVoice * UNISON_STRIDE + copy;
+                const auto copyPhase = FloatType(unisonPhases[index]) + FloatType(unisonIncrements[index]) * pSampleCount;
+                unisonPhases[index] = ValueType(copyPhase - std::floor(copyPhase));
+            }
+        amplitudes[pVoice] = ValueType(amplitudeTarget + startDifference * std::pow(retention, FloatType(pSampleCount)));
+    }
+
+    template <BoolType TAccumulate>
+    auto renderVoice(SizeType pVoice, SizeType pSampleCount) -> void
+    {
+        if (unisonCounts[pVoice] > 1)
+            renderVoice<TAccumulate, true>(pVoice, pSampleCount);
+        else
+            renderVoice<TAccumulate, false>(pVoice, pSampleCount);
+    }
+
+    // Sums the voice rows into the zeroed mix over chunks [pFirstChunk, pLastChunk), in `activeVoices` order.
+    auto mixChunks(SizeType pFirstChunk, SizeType pLastChunk) -> void
+    {
+        for (SizeType chunk = pFirstChunk; chunk < pLastChunk; chunk++)
+        {
+            const auto offset = chunk * LanesType::COUNT;
+            auto sum = LanesType::Load(mix + offset);
+            for (const auto voice : activeVoices)
+                sum = sum + LanesType::Load(samples + voice * blockStride + offset);
+            sum.Store(mix + offset);
+        }
+    }
+
+    auto releaseVoice(SizeType pVoice) -> void
+    {
+        noteVoices[voiceNotes[pVoice]] = NO_VOICE;
+        voiceNotes[pVoice] = NO_NOTE;
+        amplitudes[pVoice] = 0.0f;
+        states[pVoice] = VoiceState::IDLE;
+        std::fill(samples + pVoice * blockStride, samples + (pVoice + 1) * blockStride, 0.0f);
+        freeVoices.push_back(pVoice);
+    }
+
+public:
+    // pNoteFrequencies gives the pitch of every note the pool can be asked to play, in hertz.
+    // On the polymorphic path pWaveform may be any waveform, and a missing one is replaced by a sine.
+    VoiceBank(const Settings &pSettings, SizeType pVoiceCapacity, FrequenciesViewType pNoteFrequencies, WaveformLeashType pWaveform = WaveformLeashType())
+        : settings(pSettings),
+          waveform(std::move(pWaveform)),
+          voiceCapacity(std::max(pVoiceCapacity, SizeType(1))),
+          blockStride(computeStride(pSettings.blockSize)),
+          voiceStride(computeStride(voiceCapacity)),
+          arena(voiceStride * 4 + (voiceCapacity + 1) * blockStride + blockStride + voiceCapacity * UNISON_STRIDE * 4, 0.0f),
+          phases(arena.data()),
+          increments(phases + voiceStride),
+          amplitudes(increments + voiceStride),
+          amplitudeTargets(amplitudes + voiceStride),
+          samples(amplitudeTargets + voiceStride),
+          mix(samples + (voiceCapacity + 1) * blockStride),
+          unisonPhases(mix + blockStride),
+          unisonIncrements(unisonPhases + voiceCapacity * UNISON_STRIDE),
+          unisonStepReals(unisonIncrements + voiceCapacity * UNISON_STRIDE),
+          unisonStepImaginaries(unisonStepReals + voiceCapacity * UNISON_STRIDE),
+          states(voiceCapacity, VoiceState::IDLE),
+          activeVoices(),
+          freeVoices(),
+          voiceNotes(voiceCapacity, NO_NOTE),
+          noteVoices(pNoteFrequencies.size(), NO_VOICE),
+          noteIncrements(pNoteFrequencies.size(), 0.0f),
+          noteBends(pNoteFrequencies.size(), 1.0f),
+          unisonCounts(voiceCapacity, 1),
+          noteUnisons(pNoteFrequencies.size(), UnisonType{pSettings.unisonCount, FloatType(pSettings.unisonSpread), true}),
+          unisonSeed(0x9E3779B9u),
+          riseRetention(computeRetention(AMPLITUDE_RISE_TIME, pSettings.sampleRate)),
+          fallRetention(computeRetention(AMPLITUDE_FALL_TIME, pSettings.sampleRate)),
+          risePowers(computePowers(riseRetention)),
+          fallPowers(computePowers(fallRetention)),
+          minParallelSampleCount(MIN_PARALLEL_SAMPLE_COUNT),
+          workers(pSettings.workerCount)
+    {
+        activeVoices.reserve(voiceCapacity);
+        freeVoices.reserve(voiceCapacity);
+        // Handed out from the back, so the lowest voices are used first.
+        for (auto voice = voiceCapacity; voice-- > 0;)
+            freeVoices.push_back(voice);
+        for (SizeType note = 0; note < pNoteFrequencies.size(); note++)
+            noteIncrements[note] = ValueType(pNoteFrequencies[note] / pSettings.sampleRate);
+        if constexpr (POLYMORPHIC)
+            if (!waveform)
+                waveform = std::make_unique<SineWaveform>();
+    }
+    VoiceBank(const VoiceBank &) = delete;
+    auto operator=(const VoiceBank &) -> VoiceBank & = delete;
+    ~VoiceBank() override = default;
+
+    // Binds a voice to the note on a sounding target (stealing if needed) and releases it on a silent one.
+    // Silent targets for notes without a voice are ignored.
+    auto SetNoteAmplitude(SizeType pNote, FloatType pAmplitude) -> void
+    {
+        auto voice = noteVoices[pNote];
+        if (voice == NO_VOICE)
+        {
+            if (pAmplitude < SILENT_AMPLITUDE)
+                return;
+            // A stolen voice keeps its phase and glides from its (quietest) amplitude, so the takeover does not click.
+            voice = acquireVoice();
+            voiceNotes[voice] = pNote;
+            noteVoices[pNote] = voice;
+            increments[voice] = noteIncrements[pNote] * noteBends[pNote];
+            bindUnison(voice, pNote);
+        }
+
+        amplitudeTargets[voice] = ValueType(pAmplitude);
+        if (pAmplitude >= SILENT_AMPLITUDE)
+            states[voice] = VoiceState::ACTIVE;
+        else
+            states[voice] = VoiceState::RELEASING;
+    }
+
+    // Multiplies the note's pitch by pRatio, from the next rendered sample if it is sounding.
+    // A sounding unison stack keeps the beat rate it was bound with.
+    auto SetNoteBend(SizeType pNote, FloatType pRatio) -> void
+    {
+        noteBends[pNote] = ValueType(pRatio);
+        const auto voice = noteVoices[pNote];
+        if (voice != NO_VOICE)
+            increments[voice] = noteIncrements[pNote] * noteBends[pNote];
+    }
+
+    auto ViewNoteBend(SizeType pNote) const -> FloatType { return noteBends[pNote]; }
+
+    auto ViewWaveform() const -> const WaveformType &
+    {
+        if constexpr (POLYMORPHIC)
+            return *waveform;
+        else
+            return waveform;
+    }
+
+    // Takes effect the next time the note is bound to a voice.
+    auto SetNoteUnison(SizeType pNote, const UnisonType &pUnison) -> void
+    {
+        noteUnisons[pNote] = pUnison;
+    }
+
+    auto ViewNoteUnison(SizeType pNote) const -> const UnisonType & { return noteUnisons[pNote]; }
+    auto ViewUnisonCount(SizeType pVoice) const -> SizeType { return unisonCounts[pVoice]; }
+
+    auto ViewAmplitude(SizeType pVoice) const -> FloatType { return amplitudes[pVoice]; }
+    auto ViewIncrement(SizeType pVoice) const -> FloatType { return increments[pVoice]; }
+    // Not thread-safe; call before Start. 0 sends every block through the workers, which harnesses use to time
+    // the parallel path with fewer voices than it would otherwise take.
+    auto SetMinParallelSampleCount(SizeType pSampleCount) -> void { minParallelSampleCount = pSampleCount; }
+    auto ViewMinParallelSampleCount() const -> SizeType { return minParallelSampleCount; }
+
+    auto ViewVoiceCapacity() const -> SizeType { return voiceCapacity; }
+    auto ViewNoteCount() const -> SizeType { return noteVoices.size(); }
+    auto ViewActiveVoiceCount() const -> SizeType { return activeVoices.size(); }
+    auto ViewActiveVoices() const -> std::span<const SizeType> { return activeVoices; }
+    auto ViewState(SizeType pVoice) const -> VoiceState { return states[pVoice]; }
+    auto ViewVoiceNote(SizeType pVoice) const -> SizeType { return voiceNotes[pVoice]; }
+    auto ViewNoteVoice(SizeType pNote) const -> SizeType { return noteVoices[pNote]; }
+    auto ViewAmplitudes() const -> SamplesViewType { return SamplesViewType(amplitudes, voiceCapacity); }
+
+    auto ViewVoiceSamples(SizeType pVoice) const -> SamplesViewType
+    {
+        return SamplesViewType(samples + pVoice * blockStride, settings.blockSize);
+    }
+
+    // The note's voice row, or the silent row when the note has no voice.
+    auto ViewNoteSamples(SizeType pNote) const -> SamplesViewType
+    {
+        const auto voice = noteVoices[pNote];
+        return ViewVoiceSamples(voice == NO_VOICE ? voiceCapacity : voice);
+    }
+
+    auto ViewMix() const -> SamplesViewType
+    {
+        return SamplesViewType(mix, settings.blockSize);
+    }
+
+    // Voices are independent, so with workers each one is rendered into its own row on whichever thread claims it.
+    // The mix is then summed per group of samples, always adding the rows in `activeVoices` order, which is also
+    // the order the serial path accumulates in, so the output is bit-identical for any worker count.
+    auto Render(SizeType pSampleCount) -> void
+    {
+        const auto chunkCount = (pSampleCount + LanesType::COUNT - 1) / LanesType::COUNT;
+        const auto zero = LanesType::Broadcast(0.0f);
+        for (SizeType chunk = 0; chunk < chunkCount; chunk++)
+            zero.Store(mix + chunk * LanesType::COUNT);
+
+        if (workers.ViewWorkerCount() == 0 || activeVoices.size() * pSampleCount < minParallelSampleCount)
+        {
+            for (const auto voice : activeVoices)
+                renderVoice<true>(voice, pSampleCount);
+        }
+        else
+        {
+            workers.Run(activeVoices.size(), [this, pSampleCount](SizeType pActiveIndex)
+                        { renderVoice<false>(activeVoices[pActiveIndex], pSampleCount); });
+            const auto chunksPerTask = MIX_TASK_SAMPLE_COUNT / LanesType::COUNT;
+            workers.Run((chunkCount + chunksPerTask - 1) / chunksPerTask, [this, chunkCount, chunksPerTask](SizeType pTask)
+                        { mixChunks(pTask * chunksPerTask, std::min(chunkCount, (pTask + 1) * chunksPerTask)); });
+        }
+
+        // Return voices to the pool once their release has faded out.
+        for (SizeType activeIndex = 0; activeIndex < activeVoices.size();)
+        {
+            const auto voice = activeVoices[activeIndex];
+            if (states[voice] == VoiceState::RELEASING && amplitudes[voice] < SILENT_AMPLITUDE)
+            {
+                releaseVoice(voice);
+                activeVoices[activeIndex] = activeVoices.back();
+                activeVoices.pop_back();
+            }
+            else
+                activeIndex++;
+        }
+    }
+};
+
+#endif // VOICE_BANK_HPP
@@ -0,0 +1,17 @@
+#ifndef VOICE_STATE_HPP
+#define VOICE_STATE_HPP
+
+#include "definition.hpp"
+
+// Lifecycle of a voice: rendered while ACTIVE or RELEASING, parked and skipped once IDLE.
+enum class VoiceState
+{
+    ACTIVE,
+    RELEASING,
+    IDLE,
+};
+
+// Amplitudes below this round to silence at the output.
+static constexpr const FloatType SILENT_AMPLITUDE = 0.5;
+
+#endif // VOICE_STATE_HPP
@@ -3,42 +3,17 @@
 
 #include "waveform.hpp"
 
-template <class TSampleType, SizeType TSampleCount>
-class SawWaveform final : public Waveform<TSampleType, TSampleCount>
+// Naive ramp from -1 to 1, rising over the cycle; it aliases at high pitches (see WavetableWaveform for a band-limited saw).
+// Unlike the former unipolar ramp it has no DC offset, which would otherwise reach the resonators and the output.
+class SawWaveform final : public Waveform
 {
 public:
-    using WaveformParentType = Waveform<TSampleType, TSampleCount>;
-
-protected:
-private:
-public:
-    SawWaveform() = default;
-    SawWaveform(FloatType pFrequency, FloatType pAmplitude, FloatType pOffset = 0.0) : WaveformParentType(pFrequency, pAmplitude, pOffset) {}
     ~SawWaveform() override = default;
 
-    auto UpdateSamples() -> void override
+    auto Evaluate(LanesType pPhase, SizeType) const -> LanesType override
     {
-        const auto newOffset = std::fmod(WaveformParentType::samples.size() * WaveformParentType::frequency.Interpolate() + WaveformParentType::offset, 1);
-
-        if (
-            !WaveformParentType::amplitude.IsDifferenceSignificant() &&
-            !WaveformParentType::frequency.IsDifferenceSignificant() &&
-            WaveformParentType::offset == newOffset)
-            return;
-
-        for (SizeType i = 0; i < WaveformParentType::samples.size(); i++)
-        {
-            const auto indexDiminishedProportion = (FloatType(i) / WaveformParentType::samples.size());
-            const auto amplitude = WaveformParentType::amplitude.Interpolate(indexDiminishedProportion);
-            const auto phase = i * WaveformParentType::frequency.Interpolate(indexDiminishedProportion) + WaveformParentType::offset;
-            WaveformParentType::samples[i] = static_cast<typename WaveformParentType::SampleType>(
-                std::clamp(
-                    amplitude * std::fmod(phase, 1),
-                    FloatType(std::numeric_limits<typename WaveformParentType::SampleType>::min()),
-                    FloatType(std::numeric_limits<typename WaveformParentType::SampleType>::max())));
-        }
-        WaveformParentType::offset = newOffset;
+        return pPhase * LanesType::Broadcast(2.0f) - LanesType::Broadcast(1.0f);
     }
 };
 
-#endif // SAW_WAVEFORM_HPP
\ No newline at end of file
+#endif // SAW_WAVEFORM_HPP
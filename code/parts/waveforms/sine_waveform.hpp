@@ -1,49 +1,20 @@
 #ifndef SINE_WAVEFORM_HPP
 #define SINE_WAVEFORM_HPP
 
-#include <algorithm>
-#include <limits>
-#include <cmath>
-#include <numbers>
-
 #include "waveform.hpp"
 
-template <class TSampleType, SizeType TSampleCount>
-class SineWaveform final : public Waveform<TSampleType, TSampleCount>
+// The polynomial sine of FloatLanes; VoiceBank's default shape.
+class SineWaveform final : public Waveform
 {
 public:
-    using WaveformParentType = Waveform<TSampleType, TSampleCount>;
+    static constexpr const BoolType SINUSOIDAL = true;
 
-protected:
-private:
-public:
-    SineWaveform() = default;
-    SineWaveform(FloatType pFrequency, FloatType pAmplitude, FloatType pOffset = 0.0) : WaveformParentType(pFrequency, pAmplitude, pOffset) {}
     ~SineWaveform() override = default;
 
-    auto UpdateSamples() -> void override
+    auto Evaluate(LanesType pPhase, SizeType) const -> LanesType override
     {
-        const auto newOffset = std::fmod(WaveformParentType::samples.size() * WaveformParentType::frequency.Interpolate() + WaveformParentType::offset, 1);
-
-        if (
-            !WaveformParentType::amplitude.IsDifferenceSignificant() &&
-            !WaveformParentType::frequency.IsDifferenceSignificant() &&
-            WaveformParentType::offset == newOffset)
-            return;
-
-        for (SizeType i = 0; i < WaveformParentType::samples.size(); i++)
-        {
-            const auto indexDiminishedProportion = (FloatType(i) / WaveformParentType::samples.size());
-            const auto amplitude = WaveformParentType::amplitude.Interpolate(indexDiminishedProportion);
-            const auto phase = 2.0 * std::numbers::pi * (i * WaveformParentType::frequency.Interpolate(indexDiminishedProportion) + WaveformParentType::offset);
-            WaveformParentType::samples[i] = static_cast<typename WaveformParentType::SampleType>(
-                std::clamp(
-                    amplitude * std::sin(phase),
-                    FloatType(std::numeric_limits<typename WaveformParentType::SampleType>::min()),
-                    FloatType(std::numeric_limits<typename WaveformParentType::SampleType>::max())));
-        }
-        WaveformParentType::offset = newOffset;
+        return LanesType::Sine(pPhase);
     }
 };
 
-#endif // SINE_WAVEFORM_HPP
\ No newline at end of file
+#endif // SINE_WAVEFORM_HPP
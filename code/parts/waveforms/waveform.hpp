@@ -1,79 +1,34 @@
 #ifndef WAVEFORM_HPP
 #define WAVEFORM_HPP
 
-#include <array>
-
 #include "definition.hpp"
-#include "parts/part.hpp"
-#include "parts/interpolated.hpp"
-
-template <class TSampleType, SizeType TSampleCount>
-class Waveform : public Part<>
+#include "utilities/simd.hpp"
+
+// One cycle of the shape every voice of a VoiceBank plays, read FloatLanes::COUNT phases (in cycles, [0, 1)) at a time.
+//
+// VoiceBank<TWaveformType> stores a concrete (final) waveform inline, so every call below resolves at compile time
+// and inlines into the render loop. VoiceBank<Waveform> is the runtime-polymorphic path: it holds any waveform
+// behind a pointer and calls it virtually, for shapes chosen at runtime or defined outside this tree.
+class Waveform
 {
 public:
-    using SizeType = ::SizeType;
-    using FloatType = ::FloatType;
-    using SampleType = TSampleType;
-    using BufferType = std::array<SampleType, TSampleCount>;
-
-    static constexpr const SizeType SAMPLE_BIT_SIZE = sizeof(SampleType) * 8;
-    static constexpr const SizeType SAMPLE_COUNT = TSampleCount;
-    static constexpr const FloatType DEFAULT_FREQUENCY_MAX_DIFFERENCE = 0.0005;
-    static constexpr const FloatType DEFAULT_AMPLITUDE_MAX_DIFFERENCE = 0.0005;
+    using LanesType = FloatLanes;
 
-protected:
-    BufferType samples;
-
-private:
-public:
-    Interpolated<FloatType> frequency;
-    Interpolated<FloatType> amplitude;
-    FloatType offset;
+    // A pure sine lets unison stacks use the two-sine rotor form (see VoiceBank); other shapes render every copy.
+    static constexpr const BoolType SINUSOIDAL = false;
 
-    Waveform(
-        FloatType pFrequencyValue,
-        FloatType pAmplitudeValue,
-        FloatType pOffset = 0.0)
-        : samples(),
-          frequency(pFrequencyValue, DEFAULT_FREQUENCY_MAX_DIFFERENCE, 0.5, 0.15),
-          amplitude(pAmplitudeValue, DEFAULT_AMPLITUDE_MAX_DIFFERENCE, 0.5, 0.15),
-          offset(pOffset) {}
-    Waveform() : Waveform(0.0, 0.0, 0.0) {}
     virtual ~Waveform() = 0;
 
-    virtual auto UpdateSamples() -> void = 0;
-
-    virtual auto ViewSamples() const -> const BufferType & final
-    {
-        return samples;
-    }
-
-    auto Start() -> void override
+    // Called once per voice and block with the voice's phase increment in cycles per sample; the result is handed
+    // back to Evaluate, so band-limited shapes can leave out the harmonics that would alias at that pitch.
+    virtual auto SelectBand(FloatType) const -> SizeType
     {
-        frequency.Start();
-        amplitude.Start();
+        return 0;
     }
 
-    auto Process() -> void override
-    {
-        frequency.Process();
-        amplitude.Process();
-    }
-
-    auto Draw() -> void override
-    {
-        frequency.Draw();
-        amplitude.Draw();
-    }
-
-    auto Finish() -> void override
-    {
-        frequency.Finish();
-        amplitude.Finish();
-    }
+    virtual auto Evaluate(LanesType pPhase, SizeType pBand) const -> LanesType = 0;
 };
 
-template <class Type, SizeType SampleCount>
-Waveform<Type, SampleCount>::~Waveform() {}
+inline Waveform::~Waveform() {}
 
-#endif // WAVEFORM_HPP
\ No newline at end of file
+#endif // WAVEFORM_HPP
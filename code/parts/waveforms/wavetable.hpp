@@ -0,0 +1,123 @@
+#ifndef WAVETABLE_HPP
+#define WAVETABLE_HPP
+
+#include <array>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <concepts>
+
+#include "definition.hpp"
+
+enum class WavetableShape
+{
+    SINE,
+    SAW,
+};
+
+enum class WavetableInterpolation
+{
+    LINEAR,
+    CUBIC,
+};
+
+// Band-limited, mip-mapped single-cycle tables, built once per shape, the first time they are viewed.
+// Level 0 holds every harmonic the table can represent; each following level halves the harmonic count,
+// so a level can be picked per block that never aliases at the oscillator's phase increment.
+template <WavetableShape TShape, SizeType TTableSize = 2048>
+    requires((TTableSize & (TTableSize - 1)) == 0)
+class Wavetable final
+{
+public:
+    using ValueType = float;
+
+    static constexpr const SizeType TABLE_SIZE = TTableSize;
+    static constexpr const SizeType GUARD_SIZE = 3;
+    static constexpr const SizeType MAX_HARMONIC_COUNT = TABLE_SIZE / 2;
+    static constexpr const SizeType LEVEL_COUNT = std::bit_width(MAX_HARMONIC_COUNT);
+
+    // One guard sample before the cycle and two after it, so cubic interpolation never wraps.
+    using TableType = std::array<ValueType, TABLE_SIZE + GUARD_SIZE>;
+    using LevelsType = std::array<TableType, LEVEL_COUNT>;
+
+private:
+    LevelsType levels;
+
+    static auto computeHarmonicAmplitude(SizeType pHarmonic) -> FloatType
+    {
+        switch (TShape)
+        {
+        case WavetableShape::SINE:
+            return pHarmonic == 1 ? 1.0 : 0.0;
+        case WavetableShape::SAW:
+            // Ramp from -1 to 1, matching SawWaveform.
+            return -2.0 / (std::numbers::pi * pHarmonic);
+        }
+        return 0.0;
+    }
+
+    Wavetable() : levels()
+    {
+        // Build from the narrowest level upwards, adding only the harmonics each level gains.
+        auto cycle = std::array<FloatType, TABLE_SIZE>();
+        cycle.fill(0.0);
+        auto harmonic = SizeType(1);
+        for (SizeType level = LEVEL_COUNT; level-- > 0;)
+        {
+            const auto harmonicCount = MAX_HARMONIC_COUNT >> level;
+            for (; harmonic <= harmonicCount; harmonic++)
+            {
+                const auto harmonicAmplitude = computeHarmonicAmplitude(harmonic);
+                if (harmonicAmplitude == 0.0)
+                    continue;
+                for (SizeType i = 0; i < TABLE_SIZE; i++)
+                    cycle[i] += harmonicAmplitude * std::sin(2.0 * std::numbers::pi * FloatType(harmonic * i % TABLE_SIZE) / TABLE_SIZE);
+            }
+
+            auto &table = levels[level];
+            for (SizeType i = 0; i < TABLE_SIZE + GUARD_SIZE; i++)
+                table[i] = ValueType(cycle[(i + TABLE_SIZE - 1) % TABLE_SIZE]);
+        }
+    }
+
+public:
+    static auto View() -> const Wavetable &
+    {
+        static const auto wavetable = Wavetable();
+        return wavetable;
+    }
+
+    // The richest level whose highest harmonic stays below Nyquist at pIncrement cycles per sample.
+    static auto FindLevel(FloatType pIncrement) -> SizeType
+    {
+        const auto harmonicLimit = 0.5 / std::max(std::abs(pIncrement), 1.0 / TABLE_SIZE);
+        auto level = SizeType(0);
+        while (level + 1 < LEVEL_COUNT && FloatType(MAX_HARMONIC_COUNT >> level) > harmonicLimit)
+            level++;
+        return level;
+    }
+
+    auto ViewLevel(SizeType pLevel) const -> const TableType & { return levels[pLevel]; }
+
+    // pPosition is the phase scaled to [0, TABLE_SIZE]; the result is computed in the precision of the position.
+    // A position that rounded up to TABLE_SIZE reads the end of the last segment, which is the start of the cycle.
+    template <WavetableInterpolation TInterpolation = WavetableInterpolation::LINEAR, std::floating_point TComputeType = FloatType>
+    static auto Sample(const TableType &pTable, TComputeType pPosition) -> TComputeType
+    {
+        const auto index = std::min(SizeType(pPosition), TABLE_SIZE - 1);
+        const auto fraction = pPosition - TComputeType(index);
+        const auto *points = pTable.data() + index;
+        if constexpr (TInterpolation == WavetableInterpolation::LINEAR)
+            return points[1] + (points[2] - points[1]) * fraction;
+        else
+        {
+            // Catmull-Rom through the four surrounding points.
+            const auto p0 = TComputeType(points[0]), p1 = TComputeType(points[1]), p2 = TComputeType(points[2]), p3 = TComputeType(points[3]);
+            const auto half = TComputeType(0.5), two = TComputeType(2), three = TComputeType(3), four = TComputeType(4), five = TComputeType(5);
+            return p1 + half * fraction * (p2 - p0 + fraction * (two * p0 - five * p1 + four * p2 - p3 + fraction * (three * (p1 - p2) + p3 - p0)));
+        }
+    }
+};
+
+#endif // WAVETABLE_HPP
@@ -0,0 +1,41 @@
+#ifndef WAVETABLE_WAVEFORM_HPP
+#define WAVETABLE_WAVEFORM_HPP
+
+#include "waveform.hpp"
+#include "wavetable.hpp"
+
+// Reads band-limited wavetables at the voices' phases. SelectBand picks the mip level for each voice's pitch once per
+// block, so even a saw stays free of aliasing across the keyboard, and every lane is interpolated from that level.
+template <WavetableShape TShape, WavetableInterpolation TInterpolation = WavetableInterpolation::LINEAR>
+class WavetableWaveform final : public Waveform
+{
+public:
+    using WavetableType = Wavetable<TShape>;
+
+private:
+    const WavetableType &wavetable;
+
+public:
+    WavetableWaveform() : wavetable(WavetableType::View()) {}
+    ~WavetableWaveform() override = default;
+
+    auto SelectBand(FloatType pIncrement) const -> SizeType override
+    {
+        return WavetableType::FindLevel(pIncrement);
+    }
+
+    auto Evaluate(LanesType pPhase, SizeType pBand) const -> LanesType override
+    {
+        alignas(LanesType::ALIGNMENT) float positions[LanesType::COUNT];
+        (pPhase * LanesType::Broadcast(float(WavetableType::TABLE_SIZE))).Store(positions);
+        const auto &table = wavetable.ViewLevel(pBand);
+        for (auto &position : positions)
+            position = WavetableType::template Sample<TInterpolation>(table, position);
+        return LanesType::Load(positions);
+    }
+};
+
+using SineWavetableWaveform = WavetableWaveform<WavetableShape::SINE>;
+using SawWavetableWaveform = WavetableWaveform<WavetableShape::SAW>;
+
+#endif // WAVETABLE_WAVEFORM_HPP
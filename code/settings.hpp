@@ -0,0 +1,127 @@
+#ifndef SETTINGS_HPP
+#define SETTINGS_HPP
+
+#include <array>
+#include <string>
+#include <algorithm>
+#include <raylib.h>
+
+#include "definition.hpp"
+
+// Settings chosen at startup.
+//
+// Input is turned into control targets `controlRate` times per second by a fixed-step loop, independent of
+// `frameRate`, so lowering the frame rate on a loaded machine does not change how the instrument responds.
+//
+// The device pulls samples through the stream callback once per device period (about 10 ms with
+// raylib's default miniaudio configuration, whatever `blockSize` is), and every pull is rendered in chunks
+// of at most `blockSize` samples. Control targets are stamped one device period past the audio clock and
+// chunks are split at their sample, so input sounds about one period after it is read (plus up to one frame
+// for it to be read at all) at every block size; `gracile-latency` measures this. The block size only decides
+// how many chunks a pull is cut into:
+//
+//   block size | block at 44100 Hz | chunks per 10 ms pull at 44100 Hz | at 48000 Hz | notes
+//   -----------+-------------------+-----------------------------------+-------------+----------------------------
+//           64 |           1.45 ms |                                 7 |           8 | most per-chunk overhead
+//          128 |           2.90 ms |                                 4 |           4 |
+//          256 |           5.80 ms |                                 2 |           2 | default
+//          512 |          11.61 ms |                                 1 |           1 | one chunk per pull from here on
+//         1024 |          23.22 ms |                                 1 |           1 |
+//         4096 |          92.88 ms |                                 1 |           1 | previous fixed size
+//
+// Smaller blocks cost more CPU per second because the per-chunk work (resonance update, mixing, scopes)
+// is repeated more often, and event stamps split chunks further either way. Blocks longer than the period
+// save nothing more, since a pull is never larger than one period.
+//
+// `workerCount` extra threads help the audio thread render voices; 0 renders everything on the audio thread.
+// The output is bit-identical for every worker count.
+//
+// Everything is rendered in float32 and converted once, at the output: to a 32-bit float stream by default
+// (miniaudio, behind raylib, accepts float streams on every backend), or to 16-bit PCM with `outputBitDepth`
+// 16, optionally with TPDF dither.
+//
+// Every key plays `unisonCount` detuned copies of its note, spread evenly over `unisonSpread` cents with random
+// starting phases; 1 plays the plain note. VoiceBank::SetNoteUnison overrides this per note.
+struct Settings
+{
+    SizeType sampleRate;
+    SizeType blockSize;
+    SizeType controlRate;
+    SizeType frameRate;
+    SizeType workerCount;
+    SizeType outputBitDepth;
+    BoolType dither;
+    SizeType unisonCount;
+    SizeType unisonSpread;
+
+    auto ComputeBlockDuration() const -> FloatType
+    {
+        return FloatType(blockSize) / FloatType(sampleRate);
+    }
+
+    auto ComputeControlStepDuration() const -> FloatType
+    {
+        return 1.0 / FloatType(controlRate);
+    }
+};
+
+static constexpr const auto DEFAULT_SETTINGS = Settings{44100, 256, 1000, 30, 0, 32, false, 1, 12};
+static constexpr const auto SUPPORTED_BLOCK_SIZES = std::array<SizeType, 7>{64, 128, 256, 512, 1024, 2048, 4096};
+static constexpr const auto SUPPORTED_OUTPUT_BIT_DEPTHS = std::array<SizeType, 2>{16, 32};
+static constexpr const SizeType MAX_UNISON_COUNT = 8;
+
+// Accepts `--block-size <samples>`, `--sample-rate <hertz>`, `--control-rate <hertz>`, `--frame-rate <fps>`
+// `--workers <count>`, `--bit-depth <16|32>`, `--dither <0|1>`, `--unison <count>` and `--unison-spread <cents>`
+// from pFirstArgument onwards.
+inline auto ParseSettings(IntType pArgumentCount, CharType **pArguments, IntType pFirstArgument = 1) -> Settings
+{
+    auto settings = DEFAULT_SETTINGS;
+    for (IntType i = pFirstArgument; i + 1 < pArgumentCount; i += 2)
+    {
+        const auto name = std::string(pArguments[i]);
+        const auto value = SizeType(std::stoul(pArguments[i + 1]));
+        if (name == "--block-size")
+        {
+            if (std::find(SUPPORTED_BLOCK_SIZES.begin(), SUPPORTED_BLOCK_SIZES.end(), value) != SUPPORTED_BLOCK_SIZES.end())
+                settings.blockSize = value;
+            else
+                TraceLog(LOG_WARNING, "Unsupported block size %zu, using %zu.", value, settings.blockSize);
+        }
+        else if (name == "--sample-rate")
+            settings.sampleRate = value;
+        else if (name == "--control-rate")
+            settings.controlRate = std::max(value, SizeType(1));
+        else if (name == "--frame-rate")
+            settings.frameRate = std::max(value, SizeType(1));
+        else if (name == "--workers")
+            settings.workerCount = value;
+        else if (name == "--bit-depth")
+        {
+            if (std::find(SUPPORTED_OUTPUT_BIT_DEPTHS.begin(), SUPPORTED_OUTPUT_BIT_DEPTHS.end(), value) != SUPPORTED_OUTPUT_BIT_DEPTHS.end())
+                settings.outputBitDepth = value;
+            else
+                TraceLog(LOG_WARNING, "Unsupported bit depth %zu, using %zu.", value, settings.outputBitDepth);
+        }
+        else if (name == "--dither")
+            settings.dither = value != 0;
+        else if (name == "--unison")
+        {
+            if (value >= 1 && value <= MAX_UNISON_COUNT)
+                settings.unisonCount = value;
+            else
+                TraceLog(LOG_WARNING, "Unsupported unison count %zu, using %zu.", value, settings.unisonCount);
+        }
+        else if (name == "--unison-spread")
+            settings.unisonSpread = value;
+        else
+            TraceLog(LOG_WARNING, "Unknown option %s.", name.c_str());
+    }
+    TraceLog(LOG_INFO, "Audio: %zu Hz, %zu samples per block (%.2f ms), %zu render workers.", settings.sampleRate, settings.blockSize, settings.ComputeBlockDuration() * 1000.0, settings.workerCount);
+    TraceLog(LOG_INFO, "Output: %s.", settings.outputBitDepth == 32 ? "32-bit float" : settings.dither ? "16-bit PCM, dithered" : "16-bit PCM");
+    if (settings.unisonCount > 1)
+        TraceLog(LOG_INFO, "Unison: %zu voices per key over %zu cents.", settings.unisonCount, settings.unisonSpread);
+    TraceLog(LOG_INFO, "Control: %zu Hz, drawing at %zu FPS.", settings.controlRate, settings.frameRate);
+    return settings;
+}
+
+#endif // SETTINGS_HPP
@@ -0,0 +1,41 @@
+#ifndef ALIGNED_ALLOCATOR_HPP
+#define ALIGNED_ALLOCATOR_HPP
+
+#include <new>
+
+#include "definition.hpp"
+
+// Standard allocator handing out storage aligned to TAlignment bytes, for buffers read with vector loads.
+template <class TType, SizeType TAlignment>
+class AlignedAllocator
+{
+public:
+    using value_type = TType;
+
+    static constexpr const SizeType ALIGNMENT = TAlignment;
+
+    template <class TOtherType>
+    struct rebind
+    {
+        using other = AlignedAllocator<TOtherType, TAlignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <class TOtherType>
+    AlignedAllocator(const AlignedAllocator<TOtherType, TAlignment> &) {}
+
+    auto allocate(SizeType pCount) -> TType *
+    {
+        return static_cast<TType *>(::operator new(pCount * sizeof(TType), std::align_val_t(TAlignment)));
+    }
+
+    auto deallocate(TType *pPointer, SizeType) -> void
+    {
+        ::operator delete(pPointer, std::align_val_t(TAlignment));
+    }
+
+    template <class TOtherType>
+    auto operator==(const AlignedAllocator<TOtherType, TAlignment> &) const -> BoolType { return true; }
+};
+
+#endif // ALIGNED_ALLOCATOR_HPP
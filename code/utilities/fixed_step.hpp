@@ -0,0 +1,33 @@
+#ifndef FIXED_STEP_HPP
+#define FIXED_STEP_HPP
+
+#include <algorithm>
+
+#include "definition.hpp"
+
+// Converts elapsed wall-clock time into a whole number of fixed-duration steps, carrying the remainder.
+// After a long stall at most pMaxLag seconds are caught up, so a hitch cannot snowball.
+class FixedStep final
+{
+private:
+    FloatType stepDuration;
+    FloatType maxLag;
+    FloatType accumulatedTime;
+
+public:
+    FixedStep(FloatType pRate, FloatType pMaxLag = 0.25)
+        : stepDuration(1.0 / pRate), maxLag(pMaxLag), accumulatedTime(0.0) {}
+
+    auto ViewStepDuration() const -> FloatType { return stepDuration; }
+
+    // Returns the number of steps due after pElapsedTime more seconds.
+    auto Advance(FloatType pElapsedTime) -> SizeType
+    {
+        accumulatedTime = std::min(accumulatedTime + pElapsedTime, maxLag);
+        const auto stepCount = SizeType(accumulatedTime / stepDuration);
+        accumulatedTime -= stepCount * stepDuration;
+        return stepCount;
+    }
+};
+
+#endif // FIXED_STEP_HPP
@@ -0,0 +1,270 @@
+#ifndef MIDI_FILE_HPP
+#define MIDI_FILE_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <algorithm>
+#include <cstdint>
+
+#include "definition.hpp"
+
+enum class MidiEventKind
+{
+    NOTE_ON,
+    NOTE_OFF,
+    PITCH_BEND,
+};
+
+// Note and pitch bend events of a Standard MIDI File (format 0 or 1), merged across tracks and timed in seconds.
+// Tempo changes apply to every track, as the format requires; SMPTE time divisions are supported too.
+// Every other event (controllers, programs, system exclusive, other meta events) is skipped.
+class MidiFile final
+{
+public:
+    using BytesType = std::vector<std::uint8_t>;
+
+    struct EventType
+    {
+        FloatType time;
+        MidiEventKind kind;
+        SizeType channel;
+        SizeType key;
+        // Velocity in [0, 1] for notes, bend in [-1, 1) for PITCH_BEND.
+        FloatType value;
+    };
+    using EventsType = std::vector<EventType>;
+
+    static constexpr const FloatType DEFAULT_QUARTER_DURATION = 0.5;
+
+private:
+    struct TickedEventType
+    {
+        SizeType tick;
+        EventType event;
+    };
+
+    struct TempoType
+    {
+        SizeType tick;
+        FloatType quarterDuration;
+    };
+
+    // Bounds-checked reader over one chunk; reading past the end fails the whole load.
+    struct ReaderType
+    {
+        const BytesType &bytes;
+        SizeType position;
+        SizeType end;
+        BoolType failed = false;
+
+        auto IsAtEnd() const -> BoolType { return failed || position >= end; }
+
+        auto ReadByte() -> std::uint8_t
+        {
+            if (position >= end)
+            {
+                failed = true;
+                return 0;
+            }
+            return bytes[position++];
+        }
+
+        auto ReadBigEndian(SizeType pByteCount) -> SizeType
+        {
+            auto value = SizeType(0);
+            for (SizeType i = 0; i < pByteCount; i++)
+                value = (value << 8) | ReadByte();
+            return value;
+        }
+
+        // At most four bytes of seven bits each.
+        auto ReadVariableLength() -> SizeType
+        {
+            auto value = SizeType(0);
+            for (SizeType i = 0; i < 4; i++)
+            {
+                const auto byte = ReadByte();
+                value = (value << 7) | (byte & 0x7F);
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+            failed = true;
+            return value;
+        }
+
+        auto Skip(SizeType pByteCount) -> void
+        {
+            if (pByteCount > end - position)
+                failed = true;
+            position = std::min(position + pByteCount, end);
+        }
+    };
+
+    EventsType events;
+    FloatType duration;
+
+    static auto readTrack(ReaderType &pReader, std::vector<TickedEventType> &pEvents, std::vector<TempoType> &pTempos, SizeType &pEndTick) -> BoolType
+    {
+        auto tick = SizeType(0);
+        auto status = std::uint8_t(0);
+        while (!pReader.IsAtEnd())
+        {
+            tick += pReader.ReadVariableLength();
+            auto byte = pReader.ReadByte();
+            if (byte >= 0x80)
+            {
+                status = byte;
+                if (status < 0xF0)
+                    byte = pReader.ReadByte();
+            }
+            else if (status == 0 || status >= 0xF0)
+                // Running status only carries over channel messages.
+                return false;
+
+            if (status == 0xFF)
+            {
+                const auto type = pReader.ReadByte();
+                const auto length = pReader.ReadVariableLength();
+                if (type == 0x51 && length == 3)
+                    pTempos.push_back(TempoType{tick, FloatType(pReader.ReadBigEndian(3)) * 1e-6});
+                else
+                    pReader.Skip(length);
+                status = 0;
+                if (type == 0x2F)
+                    break;
+                continue;
+            }
+            if (status == 0xF0 || status == 0xF7)
+            {
+                pReader.Skip(pReader.ReadVariableLength());
+                status = 0;
+                continue;
+            }
+            if (status > 0xF0)
+                return false;
+
+            const auto channel = SizeType(status & 0x0F);
+            const auto first = byte;
+            switch (status & 0xF0)
+            {
+            case 0x80:
+                pReader.ReadByte();
+                pEvents.push_back(TickedEventType{tick, EventType{0.0, MidiEventKind::NOTE_OFF, channel, first, 0.0}});
+                break;
+            case 0x90:
+            {
+                const auto velocity = pReader.ReadByte();
+                const auto kind = velocity == 0 ? MidiEventKind::NOTE_OFF : MidiEventKind::NOTE_ON;
+                pEvents.push_back(TickedEventType{tick, EventType{0.0, kind, channel, first, FloatType(velocity) / 127.0}});
+                break;
+            }
+            case 0xE0:
+            {
+                const auto bend = SizeType(first) | (SizeType(pReader.ReadByte()) << 7);
+                pEvents.push_back(TickedEventType{tick, EventType{0.0, MidiEventKind::PITCH_BEND, channel, 0, (FloatType(bend) - 8192.0) / 8192.0}});
+                break;
+            }
+            case 0xA0:
+            case 0xB0:
+                pReader.ReadByte();
+                break;
+            default:
+                // Program change and channel pressure have no second data byte.
+                break;
+            }
+        }
+        pEndTick = std::max(pEndTick, tick);
+        return !pReader.failed;
+    }
+
+public:
+    MidiFile() : events(), duration(0.0) {}
+
+    static auto Load(const std::string &pPath) -> std::optional<MidiFile>
+    {
+        auto stream = std::ifstream(pPath, std::ios::binary);
+        if (!stream.is_open())
+            return std::nullopt;
+        const auto bytes = BytesType(std::istreambuf_iterator<CharType>(stream), std::istreambuf_iterator<CharType>());
+
+        auto header = ReaderType{bytes, 0, bytes.size()};
+        if (bytes.size() < 14 || std::string(bytes.begin(), bytes.begin() + 4) != "MThd")
+            return std::nullopt;
+        header.Skip(4);
+        const auto headerLength = header.ReadBigEndian(4);
+        const auto format = header.ReadBigEndian(2);
+        const auto trackCount = header.ReadBigEndian(2);
+        const auto division = header.ReadBigEndian(2);
+        if (headerLength < 6 || format > 1 || division == 0)
+            return std::nullopt;
+
+        auto tickedEvents = std::vector<TickedEventType>();
+        auto tempos = std::vector<TempoType>();
+        auto endTick = SizeType(0);
+        auto position = 8 + headerLength;
+        for (SizeType track = 0; track < trackCount && position + 8 <= bytes.size(); track++)
+        {
+            auto chunk = ReaderType{bytes, position, bytes.size()};
+            const auto isTrack = std::string(bytes.begin() + position, bytes.begin() + position + 4) == "MTrk";
+            chunk.Skip(4);
+            const auto length = chunk.ReadBigEndian(4);
+            if (length > bytes.size() - chunk.position)
+                return std::nullopt;
+            chunk.end = chunk.position + length;
+            position = chunk.end;
+            if (!isTrack)
+            {
+                // Unknown chunks are skipped and do not count as tracks.
+                track--;
+                continue;
+            }
+            if (!readTrack(chunk, tickedEvents, tempos, endTick))
+                return std::nullopt;
+        }
+
+        // Tracks are merged in order, so simultaneous events keep the order of their tracks.
+        std::stable_sort(tickedEvents.begin(), tickedEvents.end(), [](const TickedEventType &pLeft, const TickedEventType &pRight)
+                         { return pLeft.tick < pRight.tick; });
+        std::stable_sort(tempos.begin(), tempos.end(), [](const TempoType &pLeft, const TempoType &pRight)
+                         { return pLeft.tick < pRight.tick; });
+
+        // Seconds per tick are fixed for SMPTE divisions and follow the tempo map otherwise.
+        const auto smpte = (division & 0x8000) != 0;
+        const auto smpteTickDuration = smpte ? 1.0 / (FloatType(256 - (division >> 8)) * FloatType(division & 0xFF)) : 0.0;
+        auto tempoIndex = SizeType(0);
+        auto tempoTick = SizeType(0);
+        auto tempoTime = 0.0;
+        auto tickDuration = smpte ? smpteTickDuration : DEFAULT_QUARTER_DURATION / division;
+        const auto timeAt = [&](SizeType pTick)
+        {
+            while (!smpte && tempoIndex < tempos.size() && tempos[tempoIndex].tick <= pTick)
+            {
+                tempoTime += FloatType(tempos[tempoIndex].tick - tempoTick) * tickDuration;
+                tempoTick = tempos[tempoIndex].tick;
+                tickDuration = tempos[tempoIndex].quarterDuration / division;
+                tempoIndex++;
+            }
+            return tempoTime + FloatType(pTick - tempoTick) * tickDuration;
+        };
+
+        auto midi = MidiFile();
+        midi.events.reserve(tickedEvents.size());
+        for (auto &tickedEvent : tickedEvents)
+        {
+            tickedEvent.event.time = timeAt(tickedEvent.tick);
+            midi.events.push_back(tickedEvent.event);
+        }
+        midi.duration = timeAt(endTick);
+        return midi;
+    }
+
+    auto ViewEvents() const -> const EventsType & { return events; }
+
+    // Time of the last end of track, which may come after the last note.
+    auto ViewDuration() const -> FloatType { return duration; }
+};
+
+#endif // MIDI_FILE_HPP
@@ -0,0 +1,198 @@
+#ifndef PERFORMANCE_MONITOR_HPP
+#define PERFORMANCE_MONITOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+#include "definition.hpp"
+#include "utilities/spsc_queue.hpp"
+
+// Real-time counters for the audio callback, written on the audio thread and read on the UI thread.
+//
+// Every callback is timed against its deadline, the duration of the samples it produces:
+//   - load is the render time as a fraction of that deadline; above 1 the device is starved (a late block),
+//   - a callback that starts more than MISSED_INTERVAL_FACTOR deadlines after the previous one counts as missed,
+//     since the device has most likely drained its buffer in between.
+// Per-block records reach the UI thread through a lock-free queue; Collect() moves them into a bounded history
+// that can be written as CSV or JSON. Counters are plain relaxed atomics, so recording never blocks the audio thread.
+class PerformanceMonitor final
+{
+public:
+    using ClockType = std::chrono::steady_clock;
+    using TimePointType = ClockType::time_point;
+
+    struct BlockType
+    {
+        FloatType time;
+        SizeType sampleCount;
+        FloatType renderDuration;
+        FloatType load;
+        SizeType activeVoiceCount;
+        BoolType late;
+        BoolType missed;
+    };
+    using HistoryType = std::vector<BlockType>;
+    using BlockQueueType = SpscQueue<BlockType, 4096>;
+
+    static constexpr const FloatType MISSED_INTERVAL_FACTOR = 1.5;
+    static constexpr const SizeType HISTORY_CAPACITY = 1 << 16;
+
+private:
+    FloatType sampleRate;
+
+    // Audio thread only.
+    TimePointType startTime;
+    TimePointType previousStartTime;
+    FloatType previousDeadline;
+
+    BlockQueueType blocks;
+    std::atomic<SizeType> blockCount;
+    std::atomic<SizeType> lateBlockCount;
+    std::atomic<SizeType> missedBlockCount;
+    std::atomic<SizeType> droppedRecordCount;
+    std::atomic<SizeType> activeVoiceCount;
+
+    // UI thread only; the oldest records are overwritten once HISTORY_CAPACITY is reached.
+    HistoryType history;
+    SizeType historyStart;
+    FloatType recentPeakLoad;
+    FloatType recentLoad;
+
+public:
+    explicit PerformanceMonitor(FloatType pSampleRate)
+        : sampleRate(pSampleRate),
+          startTime(ClockType::now()),
+          previousStartTime(),
+          previousDeadline(0.0),
+          blocks(),
+          blockCount(0),
+          lateBlockCount(0),
+          missedBlockCount(0),
+          droppedRecordCount(0),
+          activeVoiceCount(0),
+          history(),
+          historyStart(0),
+          recentPeakLoad(0.0),
+          recentLoad(0.0)
+    {
+        history.reserve(HISTORY_CAPACITY);
+    }
+
+    // Audio thread: call when the callback starts, then pass the result to EndBlock.
+    auto BeginBlock() const -> TimePointType
+    {
+        return ClockType::now();
+    }
+
+    // Audio thread: call when the callback has produced pSampleCount samples.
+    auto EndBlock(TimePointType pStartTime, SizeType pSampleCount, SizeType pActiveVoiceCount) -> void
+    {
+        const auto endTime = ClockType::now();
+        const auto renderDuration = std::chrono::duration<FloatType>(endTime - pStartTime).count();
+        const auto deadline = FloatType(pSampleCount) / sampleRate;
+        const auto load = deadline > 0.0 ? renderDuration / deadline : 0.0;
+        const auto late = load > 1.0;
+        const auto missed = previousDeadline > 0.0 &&
+                            std::chrono::duration<FloatType>(pStartTime - previousStartTime).count() > previousDeadline * MISSED_INTERVAL_FACTOR;
+        previousStartTime = pStartTime;
+        previousDeadline = deadline;
+
+        blockCount.fetch_add(1, std::memory_order_relaxed);
+        if (late)
+            lateBlockCount.fetch_add(1, std::memory_order_relaxed);
+        if (missed)
+            missedBlockCount.fetch_add(1, std::memory_order_relaxed);
+        activeVoiceCount.store(pActiveVoiceCount, std::memory_order_relaxed);
+
+        const auto time = std::chrono::duration<FloatType>(pStartTime - startTime).count();
+        if (!blocks.TryPush(BlockType{time, pSampleCount, renderDuration, load, pActiveVoiceCount, late, missed}))
+            droppedRecordCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // UI thread: moves the records of the blocks rendered since the last call into the history.
+    auto Collect() -> void
+    {
+        auto collected = false;
+        while (const auto block = blocks.TryPop())
+        {
+            if (!collected)
+                recentPeakLoad = 0.0;
+            collected = true;
+            recentPeakLoad = std::max(recentPeakLoad, block->load);
+            recentLoad = block->load;
+            if (history.size() < HISTORY_CAPACITY)
+                history.push_back(*block);
+            else
+            {
+                history[historyStart] = *block;
+                historyStart = (historyStart + 1) % HISTORY_CAPACITY;
+            }
+        }
+    }
+
+    auto ViewBlockCount() const -> SizeType { return blockCount.load(std::memory_order_relaxed); }
+    auto ViewLateBlockCount() const -> SizeType { return lateBlockCount.load(std::memory_order_relaxed); }
+    auto ViewMissedBlockCount() const -> SizeType { return missedBlockCount.load(std::memory_order_relaxed); }
+    auto ViewDroppedRecordCount() const -> SizeType { return droppedRecordCount.load(std::memory_order_relaxed); }
+    auto ViewActiveVoiceCount() const -> SizeType { return activeVoiceCount.load(std::memory_order_relaxed); }
+
+    // Load of the latest collected block, and the peak over the blocks gathered by the latest Collect().
+    auto ViewRecentLoad() const -> FloatType { return recentLoad; }
+    auto ViewRecentPeakLoad() const -> FloatType { return recentPeakLoad; }
+
+    auto ViewHistorySize() const -> SizeType { return history.size(); }
+
+    // Oldest first.
+    auto ViewHistoryBlock(SizeType pIndex) const -> const BlockType &
+    {
+        return history[(historyStart + pIndex) % history.size()];
+    }
+
+    auto ComputeMeanLoad() const -> FloatType
+    {
+        auto total = 0.0;
+        for (const auto &block : history)
+            total += block.load;
+        return history.empty() ? 0.0 : total / history.size();
+    }
+
+    auto ComputePeakLoad() const -> FloatType
+    {
+        auto peak = 0.0;
+        for (const auto &block : history)
+            peak = std::max(peak, block.load);
+        return peak;
+    }
+
+    auto WriteCsv(std::ostream &pStream) const -> void
+    {
+        pStream << "time,sample_count,render_ms,load,active_voices,late,missed\n";
+        for (SizeType i = 0; i < history.size(); i++)
+        {
+            const auto &block = ViewHistoryBlock(i);
+            pStream << block.time << ',' << block.sampleCount << ',' << block.renderDuration * 1000.0 << ',' << block.load << ','
+                    << block.activeVoiceCount << ',' << block.late << ',' << block.missed << '\n';
+        }
+    }
+
+    auto WriteJson(std::ostream &pStream) const -> void
+    {
+        pStream << "{\n  \"blocks\": " << ViewBlockCount() << ", \"late_blocks\": " << ViewLateBlockCount()
+                << ", \"missed_blocks\": " << ViewMissedBlockCount() << ", \"dropped_records\": " << ViewDroppedRecordCount()
+                << ",\n  \"mean_load\": " << ComputeMeanLoad() << ", \"peak_load\": " << ComputePeakLoad() << ",\n  \"history\": [\n";
+        for (SizeType i = 0; i < history.size(); i++)
+        {
+            const auto &block = ViewHistoryBlock(i);
+            pStream << "    {\"time\": " << block.time << ", \"sample_count\": " << block.sampleCount << ", \"render_ms\": " << block.renderDuration * 1000.0
+                    << ", \"load\": " << block.load << ", \"active_voices\": " << block.activeVoiceCount
+                    << ", \"late\": " << (block.late ? "true" : "false") << ", \"missed\": " << (block.missed ? "true" : "false")
+                    << (i + 1 < history.size() ? "},\n" : "}\n");
+        }
+        pStream << "  ]\n}\n";
+    }
+};
+
+#endif // PERFORMANCE_MONITOR_HPP
@@ -0,0 +1,158 @@
+#ifndef REAL_FFT_HPP
+#define REAL_FFT_HPP
+
+#include <vector>
+#include <cmath>
+#include <bit>
+#include <numbers>
+#include <algorithm>
+
+#include "definition.hpp"
+#include "utilities/simd.hpp"
+#include "utilities/aligned_allocator.hpp"
+
+// Forward FFT of a real signal whose length is a power of two.
+//
+// The N real samples are packed into N / 2 complex ones (even samples as real parts, odd ones as imaginary parts),
+// transformed by an iterative radix-2 decimation-in-time FFT and untangled into the N / 2 + 1 bins of the real
+// spectrum, which halves the work of a complex transform of the same length.
+// Real and imaginary parts are kept in separate aligned arrays, and every stage's twiddles are stored contiguously,
+// so the butterflies of every stage at least FloatLanes::COUNT wide run FloatLanes::COUNT at a time.
+// All tables and scratch are allocated by the constructor; Transform never allocates.
+class RealFft final
+{
+public:
+    using ValueType = float;
+    using LanesType = FloatLanes;
+    using ArrayType = std::vector<ValueType, AlignedAllocator<ValueType, LanesType::ALIGNMENT>>;
+    using IndicesType = std::vector<SizeType>;
+
+private:
+    SizeType size;
+    SizeType halfSize;
+    IndicesType bitReversals;
+    // The twiddles of the stage with half-span h live at [h, 2h), so every stage starts aligned once h >= COUNT.
+    ArrayType stageCosines;
+    ArrayType stageSines;
+    // e^(-2 pi i k / N) for k in [0, N / 4], used to untangle the packed transform.
+    ArrayType splitCosines;
+    ArrayType splitSines;
+    ArrayType reals;
+    ArrayType imaginaries;
+
+    auto butterflies(SizeType pHalfSpan) -> void
+    {
+        const auto *cosines = stageCosines.data() + pHalfSpan;
+        const auto *sines = stageSines.data() + pHalfSpan;
+        for (SizeType start = 0; start < halfSize; start += 2 * pHalfSpan)
+        {
+            auto *topReals = reals.data() + start;
+            auto *topImaginaries = imaginaries.data() + start;
+            auto *bottomReals = topReals + pHalfSpan;
+            auto *bottomImaginaries = topImaginaries + pHalfSpan;
+            if (pHalfSpan >= LanesType::COUNT)
+                for (SizeType j = 0; j < pHalfSpan; j += LanesType::COUNT)
+                {
+                    const auto cosine = LanesType::Load(cosines + j);
+                    const auto sine = LanesType::Load(sines + j);
+                    const auto bottomReal = LanesType::Load(bottomReals + j);
+                    const auto bottomImaginary = LanesType::Load(bottomImaginaries + j);
+                    const auto topReal = LanesType::Load(topReals + j);
+                    const auto topImaginary = LanesType::Load(topImaginaries + j);
+                    const auto real = bottomReal * cosine - bottomImaginary * sine;
+                    const auto imaginary = bottomReal * sine + bottomImaginary * cosine;
+                    (topReal - real).Store(bottomReals + j);
+                    (topImaginary - imaginary).Store(bottomImaginaries + j);
+                    (topReal + real).Store(topReals + j);
+                    (topImaginary + imaginary).Store(topImaginaries + j);
+                }
+            else
+                for (SizeType j = 0; j < pHalfSpan; j++)
+                {
+                    const auto real = bottomReals[j] * cosines[j] - bottomImaginaries[j] * sines[j];
+                    const auto imaginary = bottomReals[j] * sines[j] + bottomImaginaries[j] * cosines[j];
+                    bottomReals[j] = topReals[j] - real;
+                    bottomImaginaries[j] = topImaginaries[j] - imaginary;
+                    topReals[j] += real;
+                    topImaginaries[j] += imaginary;
+                }
+        }
+    }
+
+public:
+    // pSize is rounded up to a power of two, at least 4.
+    explicit RealFft(SizeType pSize)
+        : size(std::bit_ceil(std::max(pSize, SizeType(4)))),
+          halfSize(size / 2),
+          bitReversals(halfSize),
+          stageCosines(halfSize, 0.0f),
+          stageSines(halfSize, 0.0f),
+          splitCosines(size / 4 + 1, 0.0f),
+          splitSines(size / 4 + 1, 0.0f),
+          reals(halfSize, 0.0f),
+          imaginaries(halfSize, 0.0f)
+    {
+        const auto bitCount = std::countr_zero(halfSize);
+        for (SizeType i = 0; i < halfSize; i++)
+        {
+            auto reversed = SizeType(0);
+            for (auto bit = 0; bit < bitCount; bit++)
+                reversed |= ((i >> bit) & 1) << (bitCount - 1 - bit);
+            bitReversals[i] = reversed;
+        }
+        for (SizeType halfSpan = 1; halfSpan < halfSize; halfSpan *= 2)
+            for (SizeType j = 0; j < halfSpan; j++)
+            {
+                const auto angle = -std::numbers::pi * FloatType(j) / FloatType(halfSpan);
+                stageCosines[halfSpan + j] = ValueType(std::cos(angle));
+                stageSines[halfSpan + j] = ValueType(std::sin(angle));
+            }
+        for (SizeType k = 0; k < splitCosines.size(); k++)
+        {
+            const auto angle = -2.0 * std::numbers::pi * FloatType(k) / FloatType(size);
+            splitCosines[k] = ValueType(std::cos(angle));
+            splitSines[k] = ValueType(std::sin(angle));
+        }
+    }
+
+    auto ViewSize() const -> SizeType { return size; }
+    auto ViewBinCount() const -> SizeType { return halfSize + 1; }
+
+    // Transforms the ViewSize() samples of pInput into the ViewBinCount() bins of pReals and pImaginaries.
+    auto Transform(const ValueType *pInput, ValueType *pReals, ValueType *pImaginaries) -> void
+    {
+        for (SizeType i = 0; i < halfSize; i++)
+        {
+            reals[bitReversals[i]] = pInput[2 * i];
+            imaginaries[bitReversals[i]] = pInput[2 * i + 1];
+        }
+        for (SizeType halfSpan = 1; halfSpan < halfSize; halfSpan *= 2)
+            butterflies(halfSpan);
+
+        // With Z the packed transform, X[k] = (Z[k] + conj(Z[M - k])) / 2 - i e^(-2 pi i k / N) (Z[k] - conj(Z[M - k])) / 2.
+        // Bins k and M - k share the same pair of inputs, so both are computed together.
+        pReals[0] = reals[0] + imaginaries[0];
+        pImaginaries[0] = 0.0f;
+        pReals[halfSize] = reals[0] - imaginaries[0];
+        pImaginaries[halfSize] = 0.0f;
+        for (SizeType k = 1; k <= halfSize / 2; k++)
+        {
+            const auto mirror = halfSize - k;
+            const auto evenReal = 0.5f * (reals[k] + reals[mirror]);
+            const auto evenImaginary = 0.5f * (imaginaries[k] - imaginaries[mirror]);
+            const auto oddReal = 0.5f * (imaginaries[k] + imaginaries[mirror]);
+            const auto oddImaginary = -0.5f * (reals[k] - reals[mirror]);
+            const auto cosine = splitCosines[k];
+            const auto sine = splitSines[k];
+            const auto twiddledReal = oddReal * cosine - oddImaginary * sine;
+            const auto twiddledImaginary = oddReal * sine + oddImaginary * cosine;
+            pReals[k] = evenReal + twiddledReal;
+            pImaginaries[k] = evenImaginary + twiddledImaginary;
+            // e^(-2 pi i (M - k) / N) = -conj(e^(-2 pi i k / N)), and the even and odd parts mirror as conjugates.
+            pReals[mirror] = evenReal - twiddledReal;
+            pImaginaries[mirror] = twiddledImaginary - evenImaginary;
+        }
+    }
+};
+
+#endif // REAL_FFT_HPP
@@ -0,0 +1,77 @@
+#ifndef SAMPLE_RING_HPP
+#define SAMPLE_RING_HPP
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+
+#include "definition.hpp"
+
+// Lock-free ring of samples for exactly one producer thread and one consumer thread, moved in bulk.
+// Unlike SpscQueue the capacity is chosen at runtime, but the storage is still allocated once, in the constructor,
+// so neither Write nor Read ever allocates or blocks.
+template <class TValueType>
+class SampleRing final
+{
+public:
+    using ValueType = TValueType;
+    using ValuesType = std::vector<ValueType>;
+
+private:
+    // Head and tail only ever grow; the index into `values` is masked by the power-of-two capacity.
+    // Each sits on its own cache line so the two threads do not invalidate each other's writes.
+    ValuesType values;
+    SizeType mask;
+    alignas(64) std::atomic<SizeType> head;
+    alignas(64) std::atomic<SizeType> tail;
+
+public:
+    // pCapacity is rounded up to a power of two.
+    explicit SampleRing(SizeType pCapacity)
+        : values(std::bit_ceil(std::max(pCapacity, SizeType(1)))), mask(values.size() - 1), head(0), tail(0) {}
+    SampleRing(const SampleRing &) = delete;
+    auto operator=(const SampleRing &) -> SampleRing & = delete;
+
+    auto ViewCapacity() const -> SizeType { return values.size(); }
+
+    // Producer side; copies as many of the pCount values as fit and returns how many that was.
+    auto Write(const ValueType *pValues, SizeType pCount) -> SizeType
+    {
+        const auto currentTail = tail.load(std::memory_order_relaxed);
+        const auto count = std::min(pCount, values.size() - (currentTail - head.load(std::memory_order_acquire)));
+        const auto start = currentTail & mask;
+        const auto firstCount = std::min(count, values.size() - start);
+        std::copy_n(pValues, firstCount, values.begin() + start);
+        std::copy_n(pValues + firstCount, count - firstCount, values.begin());
+        tail.store(currentTail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side; moves up to pCount values into pValues and returns how many that was.
+    auto Read(ValueType *pValues, SizeType pCount) -> SizeType
+    {
+        const auto currentHead = head.load(std::memory_order_relaxed);
+        const auto count = std::min(pCount, tail.load(std::memory_order_acquire) - currentHead);
+        const auto start = currentHead & mask;
+        const auto firstCount = std::min(count, values.size() - start);
+        std::copy_n(values.begin() + start, firstCount, pValues);
+        std::copy_n(values.begin(), count - firstCount, pValues + firstCount);
+        head.store(currentHead + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side; drops everything written so far.
+    auto Discard() -> void
+    {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Exact only when called from one of the two sides while the other is idle.
+    auto ViewSize() const -> SizeType
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SAMPLE_RING_HPP
@@ -0,0 +1,156 @@
+#ifndef SCOPE_HPP
+#define SCOPE_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "definition.hpp"
+#include "utilities/triple_buffer.hpp"
+
+// Oscilloscope snapshots of several signals, captured on the audio thread and drawn on the UI thread.
+// Each callback is decimated to at most a fixed number of columns, keeping the minimum and the maximum of the samples
+// in every column, so peaks survive however many samples fall in one column. A frame is filled piece by piece, as the
+// callback renders its sub-blocks, and always spans the whole callback. Frames reach the UI thread through a
+// TripleBuffer, so the audio thread never waits for drawing and drawing never sees a half-written frame.
+// Samples that are not captured read as zeros, and a channel left out of a frame costs nothing once its row in that
+// slot has been cleared, so silent signals can simply be skipped.
+class Scope final
+{
+public:
+    using ValueType = float;
+    using ValuesType = std::vector<ValueType>;
+
+    // Channel after channel, `columnCount` columns each, laid out with a stride of the maximum column count.
+    struct FrameType
+    {
+        SizeType columnCount;
+        SizeType sampleCount;
+        ValuesType minimums;
+        ValuesType maximums;
+        // Per channel, whether its whole row holds zeros because it was left out of the frame.
+        std::vector<BoolType> silences;
+    };
+
+private:
+    static constexpr const SizeType NOT_CAPTURED = std::numeric_limits<SizeType>::max();
+
+    SizeType channelCount;
+    SizeType maxColumnCount;
+    TripleBuffer<FrameType> frames;
+    // Audio thread only; per channel, how many samples of the frame being filled have been covered so far, or
+    // NOT_CAPTURED when it has not been captured since Begin.
+    std::vector<SizeType> capturedSampleCounts;
+
+    // Folds the zeros that samples pBegin to pEnd - 1 of the frame stand for into pChannel, one column at a time.
+    auto foldSilence(FrameType &pFrame, SizeType pChannel, SizeType pBegin, SizeType pEnd) -> void
+    {
+        if (pBegin >= pEnd)
+            return;
+        const auto firstColumn = ((pBegin + 1) * pFrame.columnCount - 1) / pFrame.sampleCount;
+        const auto lastColumn = (pEnd * pFrame.columnCount - 1) / pFrame.sampleCount;
+        auto *minimums = pFrame.minimums.data() + pChannel * maxColumnCount;
+        auto *maximums = pFrame.maximums.data() + pChannel * maxColumnCount;
+        for (auto column = firstColumn; column <= lastColumn; column++)
+        {
+            minimums[column] = std::min(minimums[column], 0.0f);
+            maximums[column] = std::max(maximums[column], 0.0f);
+        }
+    }
+
+public:
+    Scope(SizeType pChannelCount, SizeType pMaxColumnCount)
+        : channelCount(pChannelCount),
+          maxColumnCount(pMaxColumnCount),
+          frames(FrameType{pMaxColumnCount, 0, ValuesType(pChannelCount * pMaxColumnCount, 0.0f), ValuesType(pChannelCount * pMaxColumnCount, 0.0f), std::vector<BoolType>(pChannelCount, true)}),
+          capturedSampleCounts(pChannelCount, NOT_CAPTURED) {}
+
+    auto ViewChannelCount() const -> SizeType { return channelCount; }
+    auto ViewMaxColumnCount() const -> SizeType { return maxColumnCount; }
+
+    // Audio thread; starts the frame being filled, spanning pSampleCount samples of every channel.
+    auto Begin(SizeType pSampleCount) -> void
+    {
+        auto &frame = frames.AccessBack();
+        frame.columnCount = std::max(std::min(maxColumnCount, pSampleCount), SizeType(1));
+        frame.sampleCount = pSampleCount;
+        std::fill(capturedSampleCounts.begin(), capturedSampleCounts.end(), NOT_CAPTURED);
+    }
+
+    // Audio thread; folds pSampleAt(0) to pSampleAt(pSampleCount - 1), the frame's samples from pOffset on, into pChannel.
+    // Calls for one channel must come in order of pOffset; samples skipped between them read as zeros.
+    template <class TSampleAtType>
+    auto Capture(SizeType pChannel, SizeType pOffset, SizeType pSampleCount, TSampleAtType &&pSampleAt) -> void
+    {
+        if (pSampleCount == 0)
+            return;
+        auto &frame = frames.AccessBack();
+        const auto columnCount = frame.columnCount;
+        const auto frameSampleCount = frame.sampleCount;
+        auto *minimums = frame.minimums.data() + pChannel * maxColumnCount;
+        auto *maximums = frame.maximums.data() + pChannel * maxColumnCount;
+        auto &capturedSampleCount = capturedSampleCounts[pChannel];
+        if (capturedSampleCount == NOT_CAPTURED)
+        {
+            std::fill_n(minimums, columnCount, std::numeric_limits<ValueType>::max());
+            std::fill_n(maximums, columnCount, std::numeric_limits<ValueType>::lowest());
+            frame.silences[pChannel] = false;
+            capturedSampleCount = 0;
+        }
+        foldSilence(frame, pChannel, capturedSampleCount, pOffset);
+        capturedSampleCount = pOffset + pSampleCount;
+
+        // Column c holds the samples from c * frameSampleCount / columnCount up to those of column c + 1.
+        auto column = ((pOffset + 1) * columnCount - 1) / frameSampleCount;
+        auto columnEnd = (column + 1) * frameSampleCount / columnCount;
+        for (SizeType i = 0; i < pSampleCount; i++)
+        {
+            if (pOffset + i >= columnEnd)
+            {
+                column++;
+                columnEnd = (column + 1) * frameSampleCount / columnCount;
+            }
+            const auto value = ValueType(pSampleAt(i));
+            minimums[column] = std::min(minimums[column], value);
+            maximums[column] = std::max(maximums[column], value);
+        }
+    }
+
+    // Audio thread; makes the captured frame the latest one. Channels that were not captured are cleared, unless their
+    // row in this slot is still clear from an earlier frame.
+    auto Publish() -> void
+    {
+        auto &frame = frames.AccessBack();
+        for (SizeType channel = 0; channel < channelCount; channel++)
+        {
+            if (capturedSampleCounts[channel] != NOT_CAPTURED)
+                foldSilence(frame, channel, capturedSampleCounts[channel], frame.sampleCount);
+            else if (!frame.silences[channel])
+            {
+                std::fill_n(frame.minimums.data() + channel * maxColumnCount, maxColumnCount, 0.0f);
+                std::fill_n(frame.maximums.data() + channel * maxColumnCount, maxColumnCount, 0.0f);
+                frame.silences[channel] = true;
+            }
+        }
+        frames.Publish();
+    }
+
+    // UI thread; switches to the latest published frame and returns it. It stays unchanged until the next call.
+    auto Update() -> const FrameType &
+    {
+        frames.Update();
+        return frames.ViewFront();
+    }
+
+    auto ViewMinimum(const FrameType &pFrame, SizeType pChannel, SizeType pColumn) const -> ValueType
+    {
+        return pFrame.minimums[pChannel * maxColumnCount + pColumn];
+    }
+
+    auto ViewMaximum(const FrameType &pFrame, SizeType pChannel, SizeType pColumn) const -> ValueType
+    {
+        return pFrame.maximums[pChannel * maxColumnCount + pColumn];
+    }
+};
+
+#endif // SCOPE_HPP
@@ -0,0 +1,146 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "definition.hpp"
+
+// Float32 lanes of the widest vector unit enabled at compile time (AVX, SSE2), with a scalar fallback.
+// Loads and stores expect pointers aligned to ALIGNMENT.
+struct FloatLanes
+{
+#if defined(__AVX__)
+    using RegisterType = __m256;
+    static constexpr const SizeType COUNT = 8;
+#elif defined(__SSE2__)
+    using RegisterType = __m128;
+    static constexpr const SizeType COUNT = 4;
+#else
+    using RegisterType = float;
+    static constexpr const SizeType COUNT = 1;
+#endif
+    static constexpr const SizeType ALIGNMENT = 32;
+
+    RegisterType value;
+
+    static auto Broadcast(float pValue) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_set1_ps(pValue)};
+#elif defined(__SSE2__)
+        return {_mm_set1_ps(pValue)};
+#else
+        return {pValue};
+#endif
+    }
+
+    // pStart, pStart + pStep, pStart + 2 * pStep, ...
+    static auto Ramp(float pStart, float pStep) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_add_ps(_mm256_set1_ps(pStart), _mm256_mul_ps(_mm256_set1_ps(pStep), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)))};
+#elif defined(__SSE2__)
+        return {_mm_add_ps(_mm_set1_ps(pStart), _mm_mul_ps(_mm_set1_ps(pStep), _mm_setr_ps(0, 1, 2, 3)))};
+#else
+        return {pStart};
+#endif
+    }
+
+    static auto Load(const float *pSource) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_load_ps(pSource)};
+#elif defined(__SSE2__)
+        return {_mm_load_ps(pSource)};
+#else
+        return {*pSource};
+#endif
+    }
+
+    auto Store(float *pDestination) const -> void
+    {
+#if defined(__AVX__)
+        _mm256_store_ps(pDestination, value);
+#elif defined(__SSE2__)
+        _mm_store_ps(pDestination, value);
+#else
+        *pDestination = value;
+#endif
+    }
+
+    // Fractional part, valid for non-negative values.
+    auto Fraction() const -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_sub_ps(value, _mm256_round_ps(value, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC))};
+#elif defined(__SSE2__)
+        return {_mm_sub_ps(value, _mm_cvtepi32_ps(_mm_cvttps_epi32(value)))};
+#else
+        return {value - float(static_cast<IntType>(value))};
+#endif
+    }
+
+    friend auto operator+(FloatLanes pLeft, FloatLanes pRight) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_add_ps(pLeft.value, pRight.value)};
+#elif defined(__SSE2__)
+        return {_mm_add_ps(pLeft.value, pRight.value)};
+#else
+        return {pLeft.value + pRight.value};
+#endif
+    }
+
+    friend auto operator-(FloatLanes pLeft, FloatLanes pRight) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_sub_ps(pLeft.value, pRight.value)};
+#elif defined(__SSE2__)
+        return {_mm_sub_ps(pLeft.value, pRight.value)};
+#else
+        return {pLeft.value - pRight.value};
+#endif
+    }
+
+    friend auto operator*(FloatLanes pLeft, FloatLanes pRight) -> FloatLanes
+    {
+#if defined(__AVX__)
+        return {_mm256_mul_ps(pLeft.value, pRight.value)};
+#elif defined(__SSE2__)
+        return {_mm_mul_ps(pLeft.value, pRight.value)};
+#else
+        return {pLeft.value * pRight.value};
+#endif
+    }
+
+    // Horizontal sum of the lanes.
+    auto Sum() const -> float
+    {
+#if defined(__AVX__)
+        const auto half = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+        const auto pair = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+#elif defined(__SSE2__)
+        const auto pair = _mm_add_ps(value, _mm_movehl_ps(value, value));
+        return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+#else
+        return value;
+#endif
+    }
+
+    // sin(2 * pi * pPhase) for pPhase in [0, 1), accurate to about 1.4e-5.
+    static auto Sine(FloatLanes pPhase) -> FloatLanes
+    {
+        // With t = 2 * pPhase - 1 in [-1, 1), sin(2 * pi * pPhase) = -sin(pi * t) = -t * (1 - t^2) * P(t^2).
+        const auto t = pPhase * Broadcast(2.0f) - Broadcast(1.0f);
+        const auto t2 = t * t;
+        const auto polynomial = ((Broadcast(0.0633350968f) * t2 - Broadcast(0.517381742f)) * t2 + Broadcast(2.02492624f)) * t2 - Broadcast(3.14155978f);
+        return t * (Broadcast(1.0f) - t2) * polynomial;
+    }
+};
+
+#endif // SIMD_HPP
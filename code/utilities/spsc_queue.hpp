@@ -0,0 +1,60 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <optional>
+
+#include "definition.hpp"
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// Storage is fixed at compile time, so neither side ever allocates or blocks.
+template <class TValueType, SizeType TCapacity>
+    requires((TCapacity & (TCapacity - 1)) == 0)
+class SpscQueue final
+{
+public:
+    using ValueType = TValueType;
+
+    static constexpr const SizeType CAPACITY = TCapacity;
+
+private:
+    // Head and tail only ever grow; the index into `values` is taken modulo CAPACITY.
+    // Each sits on its own cache line so the two threads do not invalidate each other's writes.
+    std::array<ValueType, CAPACITY> values;
+    alignas(64) std::atomic<SizeType> head;
+    alignas(64) std::atomic<SizeType> tail;
+
+public:
+    SpscQueue() : values(), head(0), tail(0) {}
+
+    // Producer side; returns false, leaving the queue untouched, when it is full.
+    auto TryPush(const ValueType &pValue) -> BoolType
+    {
+        const auto currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == CAPACITY)
+            return false;
+        values[currentTail % CAPACITY] = pValue;
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side.
+    auto TryPop() -> std::optional<ValueType>
+    {
+        const auto currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire))
+            return std::nullopt;
+        auto value = values[currentHead % CAPACITY];
+        head.store(currentHead + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Exact only when called from one of the two sides while the other is idle.
+    auto ViewSize() const -> SizeType
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+};
+
+#endif // SPSC_QUEUE_HPP
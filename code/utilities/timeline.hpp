@@ -0,0 +1,84 @@
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <optional>
+#include <algorithm>
+#include <cctype>
+#include <raylib.h>
+
+#include "definition.hpp"
+
+// Scripted performance input, one entry per line:
+//
+//   <time in seconds> <mouse speed in pixels per second> [held keys, e.g. ZXQ]
+//
+// Each entry holds until the next one; blank lines and lines starting with '#' are ignored.
+// The last entry marks the end of the performance.
+class Timeline final
+{
+public:
+    struct EntryType
+    {
+        FloatType time;
+        FloatType mouseSpeed;
+        std::string keys;
+
+        auto IsKeyDown(IntType pKey) const -> BoolType
+        {
+            return pKey >= KEY_A && pKey <= KEY_Z && keys.find(CharType('A' + (pKey - KEY_A))) != std::string::npos;
+        }
+    };
+    using EntriesType = std::vector<EntryType>;
+
+private:
+    EntriesType entries;
+
+public:
+    Timeline() = default;
+
+    static auto Load(const std::string &pPath) -> std::optional<Timeline>
+    {
+        auto stream = std::ifstream(pPath);
+        if (!stream.is_open())
+            return std::nullopt;
+
+        auto timeline = Timeline();
+        auto line = std::string();
+        while (std::getline(stream, line))
+        {
+            if (line.empty() || line.front() == '#')
+                continue;
+            auto lineStream = std::istringstream(line);
+            auto entry = EntryType();
+            if (!(lineStream >> entry.time >> entry.mouseSpeed))
+                return std::nullopt;
+            lineStream >> entry.keys;
+            std::transform(entry.keys.begin(), entry.keys.end(), entry.keys.begin(), [](CharType pCharacter)
+                           { return CharType(std::toupper(pCharacter)); });
+            timeline.entries.push_back(std::move(entry));
+        }
+        std::stable_sort(timeline.entries.begin(), timeline.entries.end(), [](const EntryType &pLeft, const EntryType &pRight)
+                         { return pLeft.time < pRight.time; });
+        return timeline;
+    }
+
+    auto ViewDuration() const -> FloatType
+    {
+        return entries.empty() ? 0.0 : entries.back().time;
+    }
+
+    // The entry in effect at pTime.
+    auto ViewEntry(FloatType pTime) const -> const EntryType &
+    {
+        static const auto silence = EntryType{0.0, 0.0, ""};
+        const auto next = std::upper_bound(entries.begin(), entries.end(), pTime, [](FloatType pValue, const EntryType &pEntry)
+                                           { return pValue < pEntry.time; });
+        return next == entries.begin() ? silence : *std::prev(next);
+    }
+};
+
+#endif // TIMELINE_HPP
@@ -0,0 +1,59 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "definition.hpp"
+
+// Lock-free handoff of whole values from one writer thread to one reader thread.
+// The writer fills the back slot and publishes it; the reader picks up the most recently published slot.
+// Neither side ever waits for the other, and a value is never read while it is being written: the three slots are
+// always split between the writer, the reader and the one in between, which is swapped atomically.
+template <class TValueType>
+class TripleBuffer final
+{
+public:
+    using ValueType = TValueType;
+
+private:
+    static constexpr const std::uint8_t INDEX_MASK = 0x3;
+    // Set on the middle slot when it holds a value the reader has not picked up yet.
+    static constexpr const std::uint8_t FRESH = 0x4;
+
+    std::array<ValueType, 3> slots;
+    alignas(64) std::atomic<std::uint8_t> middle;
+    // Writer only.
+    alignas(64) std::uint8_t back;
+    // Reader only.
+    alignas(64) std::uint8_t front;
+
+public:
+    explicit TripleBuffer(const ValueType &pValue) : slots{pValue, pValue, pValue}, middle(1), back(0), front(2) {}
+    TripleBuffer(const TripleBuffer &) = delete;
+    auto operator=(const TripleBuffer &) -> TripleBuffer & = delete;
+
+    // Writer side; the slot to fill before the next Publish().
+    auto AccessBack() -> ValueType & { return slots[back]; }
+
+    // Writer side; hands the back slot to the reader and takes over the previous middle one.
+    auto Publish() -> void
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader side; switches to the latest published value, if there is one, and returns whether it did.
+    auto Update() -> BoolType
+    {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // Reader side; stays valid and unchanged until the next Update().
+    auto ViewFront() const -> const ValueType & { return slots[front]; }
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,100 @@
+#ifndef WAVE_FILE_HPP
+#define WAVE_FILE_HPP
+
+#include <fstream>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+
+#include "definition.hpp"
+
+// Streams mono samples to a RIFF/WAVE file, or to headerless PCM when the path ends in ".raw".
+// The header is written up front and its sizes patched on Close().
+// Float files use the extended 18-byte `fmt ` chunk and carry a `fact` chunk with the frame count, as the WAVE
+// specification requires for every format other than PCM.
+template <class TSampleType>
+class WaveFile final
+{
+public:
+    using SampleType = TSampleType;
+
+    static constexpr const SizeType SAMPLE_BIT_SIZE = sizeof(SampleType) * 8;
+    static constexpr const SizeType CHANNEL_COUNT = 1;
+    static constexpr const BoolType FLOAT_FORMAT = std::is_floating_point_v<SampleType>;
+    static constexpr const std::uint16_t FORMAT_PCM = 1;
+    static constexpr const std::uint16_t FORMAT_IEEE_FLOAT = 3;
+    static constexpr const SizeType FORMAT_CHUNK_SIZE = FLOAT_FORMAT ? 18 : 16;
+    static constexpr const SizeType FACT_CHUNK_SIZE = 4;
+    static constexpr const SizeType HEADER_SIZE = 12 + 8 + FORMAT_CHUNK_SIZE + (FLOAT_FORMAT ? 8 + FACT_CHUNK_SIZE : 0) + 8;
+
+private:
+    std::ofstream stream;
+    SizeType sampleRate;
+    SizeType sampleCount;
+    BoolType raw;
+
+    auto writeU32(std::uint32_t pValue) -> void { stream.write(reinterpret_cast<const CharType *>(&pValue), sizeof(pValue)); }
+    auto writeU16(std::uint16_t pValue) -> void { stream.write(reinterpret_cast<const CharType *>(&pValue), sizeof(pValue)); }
+
+    auto writeHeader() -> void
+    {
+        const auto dataSize = std::uint32_t(sampleCount * sizeof(SampleType));
+        const auto blockAlign = std::uint16_t(CHANNEL_COUNT * sizeof(SampleType));
+        stream.write("RIFF", 4);
+        writeU32(HEADER_SIZE - 8 + dataSize);
+        stream.write("WAVEfmt ", 8);
+        writeU32(FORMAT_CHUNK_SIZE);
+        writeU16(FLOAT_FORMAT ? FORMAT_IEEE_FLOAT : FORMAT_PCM);
+        writeU16(CHANNEL_COUNT);
+        writeU32(std::uint32_t(sampleRate));
+        writeU32(std::uint32_t(sampleRate * blockAlign));
+        writeU16(blockAlign);
+        writeU16(SAMPLE_BIT_SIZE);
+        if constexpr (FLOAT_FORMAT)
+        {
+            // No extension bytes.
+            writeU16(0);
+            stream.write("fact", 4);
+            writeU32(FACT_CHUNK_SIZE);
+            writeU32(std::uint32_t(sampleCount / CHANNEL_COUNT));
+        }
+        stream.write("data", 4);
+        writeU32(dataSize);
+    }
+
+public:
+    WaveFile(const std::string &pPath, SizeType pSampleRate)
+        : stream(pPath, std::ios::binary | std::ios::trunc),
+          sampleRate(pSampleRate),
+          sampleCount(0),
+          raw(pPath.ends_with(".raw"))
+    {
+        if (stream.is_open() && !raw)
+            writeHeader();
+    }
+    WaveFile(const WaveFile &) = delete;
+    ~WaveFile() { Close(); }
+
+    auto IsOpen() const -> BoolType { return stream.is_open(); }
+    auto ViewSampleCount() const -> SizeType { return sampleCount; }
+
+    auto Write(const SampleType *pSamples, SizeType pSampleCount) -> void
+    {
+        stream.write(reinterpret_cast<const CharType *>(pSamples), std::streamsize(pSampleCount * sizeof(SampleType)));
+        sampleCount += pSampleCount;
+    }
+
+    auto Close() -> void
+    {
+        if (!stream.is_open())
+            return;
+        if (!raw)
+        {
+            stream.seekp(0);
+            writeHeader();
+        }
+        stream.close();
+    }
+};
+
+#endif // WAVE_FILE_HPP
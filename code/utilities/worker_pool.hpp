@@ -0,0 +1,129 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#include "definition.hpp"
+
+// Fixed set of worker threads that run the tasks of one Run() call together with the calling thread.
+// Tasks are claimed one at a time from a shared counter, so faster threads take over the work of slower ones.
+// Run() neither allocates nor takes a lock; idle workers sleep on an atomic wait instead of spinning.
+// The calling thread (the audio thread) claims and runs tasks like any worker, so it only ever waits for tasks already
+// in flight on other threads. It then spins briefly and sleeps on an atomic wait that the last task to finish wakes,
+// rather than yielding in a loop: a preempted worker delays it by at most one task and does not cost it a core.
+class WorkerPool final
+{
+public:
+    using InvokeType = void (*)(void *, SizeType);
+
+    static constexpr const SizeType MAX_TASK_COUNT = 0xFFFF;
+    // Checks of the completion count before the caller goes to sleep; covers the usual microsecond-long tail.
+    static constexpr const SizeType SPIN_COUNT = 256;
+
+private:
+    // The claim word packs the generation (high 32 bits), the task count and the next task index (16 bits each),
+    // so a worker that wakes late can never claim a task of a later Run() with the state of an earlier one.
+    std::atomic<std::uint64_t> claim;
+    std::atomic<std::uint32_t> generation;
+    std::atomic<SizeType> completedTaskCount;
+    std::atomic<BoolType> stopping;
+    void *context;
+    InvokeType invoke;
+    std::vector<std::jthread> threads;
+
+    static auto pack(std::uint32_t pGeneration, SizeType pTaskCount) -> std::uint64_t
+    {
+        return (std::uint64_t(pGeneration) << 32) | (std::uint64_t(pTaskCount) << 16);
+    }
+
+    // Runs tasks of pGeneration until none are left to claim.
+    auto drain(std::uint32_t pGeneration) -> void
+    {
+        auto word = claim.load(std::memory_order_acquire);
+        while (true)
+        {
+            const auto taskCount = SizeType((word >> 16) & 0xFFFF);
+            const auto task = SizeType(word & 0xFFFF);
+            if (std::uint32_t(word >> 32) != pGeneration || task >= taskCount)
+                return;
+            if (!claim.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+            invoke(context, task);
+            if (completedTaskCount.fetch_add(1, std::memory_order_acq_rel) + 1 == taskCount)
+                completedTaskCount.notify_one();
+            word = claim.load(std::memory_order_acquire);
+        }
+    }
+
+    auto work() -> void
+    {
+        auto seenGeneration = std::uint32_t(0);
+        while (true)
+        {
+            generation.wait(seenGeneration, std::memory_order_acquire);
+            seenGeneration = generation.load(std::memory_order_acquire);
+            if (stopping.load(std::memory_order_acquire))
+                return;
+            drain(seenGeneration);
+        }
+    }
+
+public:
+    explicit WorkerPool(SizeType pWorkerCount)
+        : claim(0), generation(0), completedTaskCount(0), stopping(false), context(nullptr), invoke(nullptr), threads()
+    {
+        threads.reserve(pWorkerCount);
+        for (SizeType i = 0; i < pWorkerCount; i++)
+            threads.emplace_back([this]
+                                 { work(); });
+    }
+    WorkerPool(const WorkerPool &) = delete;
+    auto operator=(const WorkerPool &) -> WorkerPool & = delete;
+
+    ~WorkerPool()
+    {
+        stopping.store(true, std::memory_order_release);
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+    }
+
+    auto ViewWorkerCount() const -> SizeType { return threads.size(); }
+
+    // Calls pTask(i) for every i below pTaskCount and returns once all calls have finished; more than MAX_TASK_COUNT tasks run inline.
+    // The order and the threads the calls run on are unspecified, so tasks must not depend on each other.
+    template <class TTaskType>
+    auto Run(SizeType pTaskCount, TTaskType &&pTask) -> void
+    {
+        if (threads.empty() || pTaskCount < 2 || pTaskCount > MAX_TASK_COUNT)
+        {
+            for (SizeType task = 0; task < pTaskCount; task++)
+                pTask(task);
+            return;
+        }
+
+        context = &pTask;
+        invoke = [](void *pContext, SizeType pTaskIndex)
+        { (*static_cast<std::remove_reference_t<TTaskType> *>(pContext))(pTaskIndex); };
+        completedTaskCount.store(0, std::memory_order_relaxed);
+        const auto nextGeneration = generation.load(std::memory_order_relaxed) + 1;
+        claim.store(pack(nextGeneration, pTaskCount), std::memory_order_relaxed);
+        generation.store(nextGeneration, std::memory_order_release);
+        generation.notify_all();
+
+        drain(nextGeneration);
+        auto completed = completedTaskCount.load(std::memory_order_acquire);
+        for (SizeType spin = 0; spin < SPIN_COUNT && completed < pTaskCount; spin++)
+            completed = completedTaskCount.load(std::memory_order_acquire);
+        while (completed < pTaskCount)
+        {
+            completedTaskCount.wait(completed, std::memory_order_acquire);
+            completed = completedTaskCount.load(std::memory_order_acquire);
+        }
+    }
+};
+
+#endif // WORKER_POOL_HPP
@@ -0,0 +1,332 @@
+#include <raylib.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "app.hpp"
+#include "parts/voice_bank.hpp"
+#include "parts/waveforms/sine_waveform.hpp"
+#include "parts/waveforms/saw_waveform.hpp"
+#include "parts/waveforms/wavetable_waveform.hpp"
+#include "parts/resonator_bank.hpp"
+#include "parts/audio_graph.hpp"
+#include "parts/nodes/gain_node.hpp"
+#include "parts/nodes/sum_node.hpp"
+#include "parts/spectrum_analyser.hpp"
+#include "utilities/real_fft.hpp"
+
+constexpr const FloatType MIN_BENCHMARK_DURATION = 0.1;
+constexpr const auto BLOCK_SIZES = std::array<SizeType, 4>{64, 256, 1024, 4096};
+constexpr const auto VOICE_COUNTS = std::array<SizeType, 4>{1, 14, 64, 256};
+constexpr const auto WORKER_COUNTS = std::array<SizeType, 6>{0, 1, 3, 7, 11, 15};
+constexpr const SizeType SCREEN_WIDTH = 800;
+constexpr const SizeType SCREEN_HEIGHT = 450;
+
+struct ResultType
+{
+    std::string name;
+    SizeType blockSize;
+    SizeType voiceCount;
+    SizeType iterationCount;
+    FloatType nanosecondsPerIteration;
+
+    // Voice-samples (or evaluations, for per-value benchmarks) produced per second.
+    auto ComputeSamplesPerSecond() const -> FloatType { return FloatType(blockSize * voiceCount) * 1e9 / nanosecondsPerIteration; }
+    auto ComputeNanosecondsPerVoice() const -> FloatType { return nanosecondsPerIteration / voiceCount; }
+};
+
+// Keeps results observable so the optimiser cannot drop the measured work.
+static volatile FloatType sink = 0.0;
+
+// Runs pBody until MIN_BENCHMARK_DURATION has elapsed, after one warm-up call.
+template <class TBodyType>
+auto Measure(const std::string &pName, SizeType pBlockSize, SizeType pVoiceCount, TBodyType &&pBody) -> ResultType
+{
+    pBody();
+    auto iterationCount = SizeType(0);
+    const auto startTime = std::chrono::steady_clock::now();
+    auto elapsed = 0.0;
+    do
+    {
+        for (SizeType i = 0; i < 16; i++)
+            pBody();
+        iterationCount += 16;
+        elapsed = std::chrono::duration<FloatType>(std::chrono::steady_clock::now() - startTime).count();
+    } while (elapsed < MIN_BENCHMARK_DURATION);
+    return ResultType{pName, pBlockSize, pVoiceCount, iterationCount, elapsed * 1e9 / iterationCount};
+}
+
+// The waveform a VoiceBank<TWaveformType> is built with: TConcreteType inline, or behind a pointer on the virtual path.
+template <class TWaveformType, class TConcreteType>
+auto CreateBenchmarkWaveform() -> typename VoiceBank<TWaveformType>::WaveformLeashType
+{
+    if constexpr (VoiceBank<TWaveformType>::POLYMORPHIC)
+        return std::make_unique<TConcreteType>();
+    else
+        return TConcreteType();
+}
+
+// Oscillators per waveform: every voice renders TConcreteType, dispatched statically or, with TWaveformType left as
+// the abstract Waveform, virtually. With a pUnisonCount greater than 1 every voice plays a detuned stack of that many copies.
+// Targets alternate every block, so every voice is always gliding through the per-sample amplitude one-pole, in both
+// directions, and its closed-form evaluation is part of every figure.
+template <class TConcreteType = SineWaveform, class TWaveformType = TConcreteType>
+auto BenchmarkVoiceBank(const std::string &pName, SizeType pUnisonCount, std::vector<ResultType> &pResults) -> void
+{
+    for (const auto blockSize : BLOCK_SIZES)
+        for (const auto voiceCount : VOICE_COUNTS)
+        {
+            auto settings = DEFAULT_SETTINGS;
+            settings.blockSize = blockSize;
+            settings.unisonCount = pUnisonCount;
+            auto frequencies = std::vector<FloatType>(voiceCount);
+            for (SizeType note = 0; note < voiceCount; note++)
+                frequencies[note] = 200.0 + note * 3.0;
+            auto voices = VoiceBank<TWaveformType>(settings, voiceCount, frequencies, CreateBenchmarkWaveform<TWaveformType, TConcreteType>());
+            auto toggle = false;
+            pResults.push_back(Measure(pName, blockSize, voiceCount, [&]
+                                       {
+                                           toggle = !toggle;
+                                           for (SizeType note = 0; note < voiceCount; note++)
+                                               voices.SetNoteAmplitude(note, toggle ? 5000.0 : 4000.0);
+                                           voices.Render(blockSize);
+                                           sink = sink + voices.ViewMix()[blockSize / 2]; }));
+        }
+}
+
+// Scaling of the parallel voice renderer; the worker count is appended to the benchmark name.
+auto BenchmarkVoiceBankWorkers(std::vector<ResultType> &pResults) -> void
+{
+    constexpr const SizeType VOICE_COUNT = 256;
+    constexpr const SizeType BLOCK_SIZE = 1024;
+    auto frequencies = std::vector<FloatType>(VOICE_COUNT);
+    for (SizeType note = 0; note < VOICE_COUNT; note++)
+        frequencies[note] = 200.0 + note * 3.0;
+    for (const auto workerCount : WORKER_COUNTS)
+    {
+        auto settings = DEFAULT_SETTINGS;
+        settings.blockSize = BLOCK_SIZE;
+        settings.workerCount = workerCount;
+        auto voices = VoiceBank<>(settings, VOICE_COUNT, frequencies);
+        auto toggle = false;
+        auto result = Measure("voice_bank_workers", BLOCK_SIZE, VOICE_COUNT, [&]
+                              {
+                                  toggle = !toggle;
+                                  for (SizeType note = 0; note < VOICE_COUNT; note++)
+                                      voices.SetNoteAmplitude(note, toggle ? 5000.0 : 4000.0);
+                                  voices.Render(BLOCK_SIZE);
+                                  sink = sink + voices.ViewMix()[BLOCK_SIZE / 2]; });
+        result.name += "_" + std::to_string(workerCount);
+        pResults.push_back(result);
+    }
+}
+
+// A full pool asked for a new note every block, so each block steals a voice.
+auto BenchmarkVoiceStealing(std::vector<ResultType> &pResults) -> void
+{
+    constexpr const SizeType NOTE_COUNT = 128;
+    constexpr const SizeType VOICE_CAPACITY = 32;
+    auto frequencies = std::vector<FloatType>(NOTE_COUNT);
+    for (SizeType note = 0; note < NOTE_COUNT; note++)
+        frequencies[note] = 100.0 + note * 7.0;
+    for (const auto blockSize : BLOCK_SIZES)
+    {
+        auto settings = DEFAULT_SETTINGS;
+        settings.blockSize = blockSize;
+        auto voices = VoiceBank<>(settings, VOICE_CAPACITY, frequencies);
+        auto note = SizeType(0);
+        pResults.push_back(Measure("voice_stealing", blockSize, VOICE_CAPACITY, [&]
+                                   {
+                                       voices.SetNoteAmplitude(note, 1000.0 + note);
+                                       note = (note + 1) % NOTE_COUNT;
+                                       voices.Render(blockSize);
+                                       sink = sink + voices.ViewMix()[blockSize / 2]; }));
+    }
+}
+
+// Modes stand in for sympathetic strings; a full-scale sine keeps every block ringing so the bank never rests.
+auto BenchmarkResonatorBank(std::vector<ResultType> &pResults) -> void
+{
+    for (const auto blockSize : BLOCK_SIZES)
+        for (const auto modeCount : VOICE_COUNTS)
+        {
+            auto settings = DEFAULT_SETTINGS;
+            settings.blockSize = blockSize;
+            auto modes = std::vector<ResonatorBank<>::ModeType>(modeCount);
+            for (SizeType mode = 0; mode < modeCount; mode++)
+                modes[mode] = ResonatorBank<>::ModeType{200.0 + mode * 3.0, 1.0, 0.15};
+            auto resonators = ResonatorBank(settings, modes);
+            auto input = std::vector<float>(blockSize);
+            for (SizeType i = 0; i < blockSize; i++)
+                input[i] = float(5000.0 * std::sin(2.0 * PI * 440.0 * i / settings.sampleRate));
+            pResults.push_back(Measure("resonator_bank", blockSize, modeCount, [&]
+                                       {
+                                           resonators.Render(input, blockSize);
+                                           sink = sink + resonators.ViewOutput()[blockSize / 2]; }));
+        }
+}
+
+// A chain of gain stages; liveness analysis keeps it at two buffers however long it gets.
+auto BenchmarkAudioGraph(std::vector<ResultType> &pResults) -> void
+{
+    for (const auto blockSize : BLOCK_SIZES)
+        for (const auto nodeCount : VOICE_COUNTS)
+        {
+            auto settings = DEFAULT_SETTINGS;
+            settings.blockSize = blockSize;
+            auto graph = AudioGraph(settings);
+            auto previous = graph.AddNode(std::make_unique<SumNode<>>(0));
+            for (SizeType node = 0; node < nodeCount; node++)
+            {
+                const auto gain = graph.AddNode(std::make_unique<GainNode<>>(0.5f));
+                graph.Connect({previous, 0}, gain, 0);
+                previous = gain;
+            }
+            graph.SetOutput({previous, 0});
+            graph.Compile();
+            pResults.push_back(Measure("audio_graph", blockSize, nodeCount, [&]
+                                       {
+                                           graph.Render(blockSize);
+                                           sink = sink + graph.ViewOutput()[blockSize / 2]; }));
+        }
+}
+
+// One transform, then what the UI thread spends per audio block on the overlapping analysis windows.
+auto BenchmarkSpectrumAnalyser(std::vector<ResultType> &pResults) -> void
+{
+    constexpr const auto FFT_SIZE = SpectrumAnalyser<>::FFT_SIZE;
+    auto fft = RealFft(FFT_SIZE);
+    auto signal = RealFft::ArrayType(FFT_SIZE);
+    for (SizeType i = 0; i < FFT_SIZE; i++)
+        signal[i] = float(std::sin(2.0 * PI * 440.0 * i / DEFAULT_SETTINGS.sampleRate));
+    auto reals = RealFft::ArrayType(fft.ViewBinCount());
+    auto imaginaries = RealFft::ArrayType(fft.ViewBinCount());
+    pResults.push_back(Measure("real_fft", FFT_SIZE, 1, [&]
+                               {
+                                   fft.Transform(signal.data(), reals.data(), imaginaries.data());
+                                   sink = sink + reals[10]; }));
+
+    for (const auto blockSize : BLOCK_SIZES)
+    {
+        auto settings = DEFAULT_SETTINGS;
+        settings.blockSize = blockSize;
+        auto analyser = SpectrumAnalyser(settings, 32768.0);
+        analyser.Enable();
+        pResults.push_back(Measure("spectrum_analyser", blockSize, 1, [&]
+                                   {
+                                       analyser.Push(signal.data(), blockSize);
+                                       analyser.Process();
+                                       sink = sink + analyser.ViewLevels()[10]; }));
+    }
+}
+
+auto BenchmarkComputeResonance(std::vector<ResultType> &pResults) -> void
+{
+    constexpr const SizeType RATIO_COUNT = 1024;
+    auto ratios = std::vector<FloatType>(RATIO_COUNT);
+    for (SizeType i = 0; i < RATIO_COUNT; i++)
+        ratios[i] = 1.0 + 3.0 * FloatType(i) / RATIO_COUNT;
+    auto result = Measure("compute_resonance", 1, RATIO_COUNT, [&]
+                          {
+                              auto total = 0.0;
+                              for (const auto ratio : ratios)
+                                  total += App<>::ComputeResonance(ratio);
+                              sink = sink + total; });
+    pResults.push_back(result);
+}
+
+// The view geometry runs on a whole App.
+auto BenchmarkApp(std::vector<ResultType> &pResults) -> void
+{
+    for (const auto blockSize : BLOCK_SIZES)
+    {
+        auto settings = DEFAULT_SETTINGS;
+        settings.blockSize = blockSize;
+        auto app = App(settings);
+        auto block = std::vector<App<>::MixerType::FloatSampleType>(blockSize);
+        app.Perform(600.0, [](KeyboardKey)
+                    { return true; });
+        app.Tick();
+        app.Render(block.data(), blockSize);
+
+        pResults.push_back(Measure("build_geometry", blockSize, App<>::SCOPE_CHANNEL_COUNT, [&]
+                                   {
+                                       const auto &geometry = app.BuildGeometry(SCREEN_WIDTH, SCREEN_HEIGHT);
+                                       sink = sink + geometry.keyPoints.size(); }));
+    }
+}
+
+auto WriteCsv(std::ostream &pStream, const std::vector<ResultType> &pResults) -> void
+{
+    pStream << "benchmark,block_size,voice_count,iterations,ns_per_iteration,ns_per_voice,samples_per_second\n";
+    for (const auto &result : pResults)
+        pStream << result.name << ',' << result.blockSize << ',' << result.voiceCount << ',' << result.iterationCount << ','
+                << result.nanosecondsPerIteration << ',' << result.ComputeNanosecondsPerVoice() << ',' << result.ComputeSamplesPerSecond() << '\n';
+}
+
+auto WriteJson(std::ostream &pStream, const std::vector<ResultType> &pResults) -> void
+{
+    pStream << "[\n";
+    for (SizeType i = 0; i < pResults.size(); i++)
+    {
+        const auto &result = pResults[i];
+        pStream << "  {\"benchmark\": \"" << result.name << "\", \"block_size\": " << result.blockSize << ", \"voice_count\": " << result.voiceCount
+                << ", \"iterations\": " << result.iterationCount << ", \"ns_per_iteration\": " << result.nanosecondsPerIteration
+                << ", \"ns_per_voice\": " << result.ComputeNanosecondsPerVoice() << ", \"samples_per_second\": " << result.ComputeSamplesPerSecond()
+                << (i + 1 < pResults.size() ? "},\n" : "}\n");
+    }
+    pStream << "]\n";
+}
+
+// Microbenchmarks for the DSP and UI hot paths, written as CSV (default) or JSON.
+//
+//   gracile-bench [--json] [--output <path>]
+int main(int argc, char **argv)
+{
+    auto json = false;
+    auto outputPath = std::string();
+    for (IntType i = 1; i < argc; i++)
+    {
+        const auto argument = std::string(argv[i]);
+        if (argument == "--json")
+            json = true;
+        else if (argument == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+            TraceLog(LOG_WARNING, "Unknown option %s.", argument.c_str());
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    auto results = std::vector<ResultType>();
+    BenchmarkVoiceBank("voice_bank", 1, results);
+    BenchmarkVoiceBank<SineWaveform, Waveform>("voice_bank_virtual", 1, results);
+    BenchmarkVoiceBank<SawWaveform>("voice_bank_saw", 1, results);
+    BenchmarkVoiceBank<SineWavetableWaveform>("voice_bank_sine_wavetable", 1, results);
+    BenchmarkVoiceBank<SawWavetableWaveform>("voice_bank_saw_wavetable", 1, results);
+    BenchmarkVoiceBank<SawWavetableWaveform, Waveform>("voice_bank_saw_wavetable_virtual", 1, results);
+    BenchmarkVoiceBank("voice_bank_unison_8", 8, results);
+    BenchmarkVoiceBank<SawWaveform>("voice_bank_saw_unison_8", 8, results);
+    BenchmarkVoiceBankWorkers(results);
+    BenchmarkVoiceStealing(results);
+    BenchmarkResonatorBank(results);
+    BenchmarkAudioGraph(results);
+    BenchmarkSpectrumAnalyser(results);
+    BenchmarkComputeResonance(results);
+    BenchmarkApp(results);
+
+    auto file = std::ofstream();
+    if (!outputPath.empty())
+        file.open(outputPath);
+    auto &stream = outputPath.empty() ? std::cout : file;
+    if (json)
+        WriteJson(stream, results);
+    else
+        WriteCsv(stream, results);
+}
@@ -0,0 +1,265 @@
+#include <raylib.h>
+#include <string>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <iostream>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "app.hpp"
+#include "utilities/fixed_step.hpp"
+
+constexpr const auto BLOCK_SIZES = std::array<SizeType, 4>{64, 256, 1024, 4096};
+constexpr const auto FRAME_RATES = std::array<SizeType, 3>{30, 60, 120};
+constexpr const auto WORKER_COUNTS = std::array<SizeType, 2>{0, 2};
+constexpr const SizeType DEFAULT_TRIAL_COUNT = 50;
+// Seconds between device pulls; raylib's default miniaudio configuration asks for about 10 ms at a time.
+constexpr const FloatType DEFAULT_PERIOD_DURATION = 0.01;
+constexpr const auto TRIAL_KEY = KEY_Z;
+constexpr const FloatType TRIAL_MOUSE_VELOCITY = 600.0;
+// The first output sample at or above this magnitude (-60 dBFS) counts as the onset.
+constexpr const float ONSET_THRESHOLD = 1e-3f;
+// The output has to stay below ONSET_THRESHOLD this long after a release before the next trial starts.
+constexpr const FloatType QUIET_DURATION = 0.05;
+constexpr const FloatType TRIAL_TIMEOUT = 10.0;
+
+struct ResultType
+{
+    SizeType blockSize;
+    SizeType frameRate;
+    SizeType workerCount;
+    SizeType periodSampleCount;
+    // Seconds, sorted.
+    std::vector<FloatType> latencies;
+    std::vector<FloatType> jitters;
+    // Seconds spent in App::Render per pull, sorted.
+    std::vector<FloatType> renderDurations;
+};
+
+// Nearest-rank percentile of sorted values, in milliseconds.
+auto ComputePercentile(const std::vector<FloatType> &pValues, FloatType pPercentile) -> FloatType
+{
+    if (pValues.empty())
+        return 0.0;
+    const auto rank = SizeType(std::ceil(pPercentile / 100.0 * pValues.size()));
+    return pValues[std::clamp(rank, SizeType(1), pValues.size()) - 1] * 1000.0;
+}
+
+// xorshift32, uniform in [0, 1); seeded the same for every configuration so runs are comparable.
+auto NextUniform(std::uint32_t &pState) -> FloatType
+{
+    pState ^= pState << 13;
+    pState ^= pState >> 17;
+    pState ^= pState << 5;
+    return FloatType(pState) / 4294967296.0;
+}
+
+// Plays the instrument against a null audio device on a simulated clock, without a window.
+//
+// The device pulls pPeriodSampleCount samples at a time through App::Render, passing the simulated time of the pull,
+// and the app renders each pull in chunks of at most blockSize. The UI runs a frame every 1 / frameRate seconds, like
+// main.cpp: it latches input with Perform(), stamps it with EstimateEventTime() and advances the control steps.
+// A trial presses TRIAL_KEY at a random time, and its latency runs from that press to the first sample of the output
+// at or above ONSET_THRESHOLD, taken as leaving the device at the start of its pull plus its offset in the pull.
+// Buffering inside a real device adds a constant on top. Latency is therefore fully simulated and repeatable; the
+// time App::Render takes is measured for real and reported on its own, which is where the worker count shows.
+// A trial only holds one voice, far below VoiceBank::MIN_PARALLEL_SAMPLE_COUNT, so with workers the harness lowers
+// that threshold to 0 and every chunk goes through the worker pool; otherwise the worker rows would time the serial path.
+// A trial's jitter is its distance from the configuration's median latency.
+//
+// Input enters through Perform() with a predicate standing in for IsKeyDown and a fixed mouse velocity standing in
+// for GetMouseDelta, so the raylib input path and the time the window system takes to deliver events are not covered.
+auto MeasureLatency(SizeType pBlockSize, SizeType pFrameRate, SizeType pWorkerCount, SizeType pPeriodSampleCount, SizeType pTrialCount, const Settings &pSettings) -> ResultType
+{
+    using ClockType = PerformanceMonitor::ClockType;
+    using TimePointType = PerformanceMonitor::TimePointType;
+
+    auto settings = pSettings;
+    settings.blockSize = pBlockSize;
+    settings.frameRate = pFrameRate;
+    settings.workerCount = pWorkerCount;
+    settings.outputBitDepth = 32;
+
+    auto app = App(settings);
+    if (pWorkerCount > 0)
+        app.SetMinParallelSampleCount(0);
+    auto control = FixedStep(settings.controlRate);
+    auto pull = std::vector<App<>::MixerType::FloatSampleType>(pPeriodSampleCount);
+    auto result = ResultType{pBlockSize, pFrameRate, pWorkerCount, pPeriodSampleCount, {}, {}, {}};
+    app.Start();
+
+    const auto frameDuration = 1.0 / pFrameRate;
+    const auto periodDuration = FloatType(pPeriodSampleCount) / settings.sampleRate;
+    const auto toTimePoint = [](FloatType pTime)
+    { return TimePointType(std::chrono::duration_cast<ClockType::duration>(std::chrono::duration<FloatType>(pTime))); };
+    auto seed = std::uint32_t(0x9E3779B9u);
+    auto frameCount = SizeType(0);
+    auto pullCount = SizeType(0);
+    auto keyDown = false;
+    auto measuring = false;
+    auto settling = false;
+    auto pressTime = 0.0;
+    auto quietTime = 0.0;
+    auto nextPressTime = NextUniform(seed) * frameDuration;
+
+    while (result.latencies.size() < pTrialCount)
+    {
+        const auto frameTime = frameCount * frameDuration;
+        const auto pullTime = pullCount * periodDuration;
+        if (frameTime <= pullTime)
+        {
+            if (!measuring && nextPressTime <= frameTime)
+            {
+                // Pressed between the previous frame and this one.
+                keyDown = true;
+                measuring = true;
+                pressTime = nextPressTime;
+            }
+            app.Perform(keyDown ? TRIAL_MOUSE_VELOCITY : 0.0, [keyDown](KeyboardKey pKey)
+                        { return keyDown && pKey == TRIAL_KEY; });
+            app.TickFrame(control.Advance(frameDuration), app.EstimateEventTime(toTimePoint(frameTime)));
+            app.CollectPerformance();
+            frameCount++;
+            continue;
+        }
+
+        const auto startTime = ClockType::now();
+        app.Render(pull.data(), pPeriodSampleCount, toTimePoint(pullTime));
+        result.renderDurations.push_back(std::chrono::duration<FloatType>(ClockType::now() - startTime).count());
+        pullCount++;
+
+        const auto onset = std::find_if(pull.begin(), pull.end(), [](float pSample)
+                                        { return std::abs(pSample) >= ONSET_THRESHOLD; });
+        if (measuring && onset != pull.end())
+        {
+            const auto sampleOffset = FloatType(onset - pull.begin()) / settings.sampleRate;
+            result.latencies.push_back(pullTime + sampleOffset - pressTime);
+            measuring = false;
+            keyDown = false;
+            settling = true;
+            nextPressTime = std::numeric_limits<FloatType>::max();
+        }
+        else if (measuring && pullTime - pressTime > TRIAL_TIMEOUT)
+        {
+            TraceLog(LOG_WARNING, "No onset within %.0f s at %zu samples, %zu FPS, %zu workers.", TRIAL_TIMEOUT, pBlockSize, pFrameRate, pWorkerCount);
+            break;
+        }
+
+        quietTime = onset != pull.end() ? 0.0 : quietTime + periodDuration;
+        if (settling && quietTime >= QUIET_DURATION)
+        {
+            // The next press lands at a random phase against both the frames and the pulls.
+            settling = false;
+            nextPressTime = pullTime + periodDuration + NextUniform(seed) * std::max(frameDuration, periodDuration) * 2.0;
+        }
+    }
+    app.Finish();
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+    const auto median = ComputePercentile(result.latencies, 50.0) / 1000.0;
+    for (const auto latency : result.latencies)
+        result.jitters.push_back(std::abs(latency - median));
+    std::sort(result.jitters.begin(), result.jitters.end());
+    std::sort(result.renderDurations.begin(), result.renderDurations.end());
+    return result;
+}
+
+auto WriteCsv(std::ostream &pStream, const std::vector<ResultType> &pResults) -> void
+{
+    pStream << "block_size,frame_rate,workers,period,trials,latency_p50_ms,latency_p99_ms,latency_max_ms,jitter_p50_ms,jitter_p99_ms,jitter_max_ms,render_p50_ms,render_p99_ms\n";
+    for (const auto &result : pResults)
+        pStream << result.blockSize << ',' << result.frameRate << ',' << result.workerCount << ',' << result.periodSampleCount << ',' << result.latencies.size() << ','
+                << ComputePercentile(result.latencies, 50.0) << ',' << ComputePercentile(result.latencies, 99.0) << ',' << ComputePercentile(result.latencies, 100.0) << ','
+                << ComputePercentile(result.jitters, 50.0) << ',' << ComputePercentile(result.jitters, 99.0) << ',' << ComputePercentile(result.jitters, 100.0) << ','
+                << ComputePercentile(result.renderDurations, 50.0) << ',' << ComputePercentile(result.renderDurations, 99.0) << '\n';
+}
+
+auto WriteJson(std::ostream &pStream, const std::vector<ResultType> &pResults) -> void
+{
+    pStream << "[\n";
+    for (SizeType i = 0; i < pResults.size(); i++)
+    {
+        const auto &result = pResults[i];
+        pStream << "  {\"block_size\": " << result.blockSize << ", \"frame_rate\": " << result.frameRate << ", \"workers\": " << result.workerCount
+                << ", \"period\": " << result.periodSampleCount << ", \"trials\": " << result.latencies.size()
+                << ", \"latency_p50_ms\": " << ComputePercentile(result.latencies, 50.0) << ", \"latency_p99_ms\": " << ComputePercentile(result.latencies, 99.0)
+                << ", \"latency_max_ms\": " << ComputePercentile(result.latencies, 100.0)
+                << ", \"jitter_p50_ms\": " << ComputePercentile(result.jitters, 50.0) << ", \"jitter_p99_ms\": " << ComputePercentile(result.jitters, 99.0)
+                << ", \"jitter_max_ms\": " << ComputePercentile(result.jitters, 100.0)
+                << ", \"render_p50_ms\": " << ComputePercentile(result.renderDurations, 50.0) << ", \"render_p99_ms\": " << ComputePercentile(result.renderDurations, 99.0)
+                << (i + 1 < pResults.size() ? "},\n" : "}\n");
+    }
+    pStream << "]\n";
+}
+
+// Input-to-sound latency and jitter for every block size, frame rate and worker count, with the render time per pull,
+// written as CSV (default) or JSON. --period sets the device period in milliseconds (10 by default).
+// With --max-p99 the exit status is 1 when any configuration's p99 latency exceeds the given milliseconds,
+// or when a configuration finishes fewer trials than asked for, so changes can be gated on latency.
+//
+//   gracile-latency [--trials <count>] [--max-p99 <ms>] [--period <ms>] [--json] [--output <path>] [--sample-rate <hertz>] [--control-rate <hertz>]
+int main(int argc, char **argv)
+{
+    auto json = false;
+    auto outputPath = std::string();
+    auto trialCount = DEFAULT_TRIAL_COUNT;
+    auto maxP99 = 0.0;
+    auto periodDuration = DEFAULT_PERIOD_DURATION;
+    auto settingArguments = std::vector<CharType *>{argv[0]};
+    for (IntType i = 1; i < argc; i++)
+    {
+        const auto argument = std::string(argv[i]);
+        if (argument == "--json")
+            json = true;
+        else if (argument == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (argument == "--trials" && i + 1 < argc)
+            trialCount = std::max(SizeType(std::stoul(argv[++i])), SizeType(1));
+        else if (argument == "--max-p99" && i + 1 < argc)
+            maxP99 = std::stod(argv[++i]);
+        else if (argument == "--period" && i + 1 < argc)
+            periodDuration = std::stod(argv[++i]) / 1000.0;
+        else if ((argument == "--sample-rate" || argument == "--control-rate") && i + 1 < argc)
+        {
+            settingArguments.push_back(argv[i]);
+            settingArguments.push_back(argv[++i]);
+        }
+        else
+            TraceLog(LOG_WARNING, "Unknown option %s.", argument.c_str());
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+    const auto settings = ParseSettings(IntType(settingArguments.size()), settingArguments.data());
+    auto results = std::vector<ResultType>();
+    auto passed = true;
+    const auto periodSampleCount = std::max(SizeType(std::lround(periodDuration * settings.sampleRate)), SizeType(1));
+    for (const auto blockSize : BLOCK_SIZES)
+        for (const auto frameRate : FRAME_RATES)
+            for (const auto workerCount : WORKER_COUNTS)
+            {
+                results.push_back(MeasureLatency(blockSize, frameRate, workerCount, periodSampleCount, trialCount, settings));
+                const auto &result = results.back();
+                if (maxP99 > 0.0 && (result.latencies.size() < trialCount || ComputePercentile(result.latencies, 99.0) > maxP99))
+                {
+                    TraceLog(LOG_WARNING, "p99 latency %.2f ms at %zu samples, %zu FPS, %zu workers exceeds %.2f ms.",
+                             ComputePercentile(result.latencies, 99.0), blockSize, frameRate, workerCount, maxP99);
+                    passed = false;
+                }
+            }
+
+    auto file = std::ofstream();
+    if (!outputPath.empty())
+        file.open(outputPath);
+    auto &stream = outputPath.empty() ? std::cout : file;
+    if (json)
+        WriteJson(stream, results);
+    else
+        WriteCsv(stream, results);
+    return passed ? 0 : 1;
+}
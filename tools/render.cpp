@@ -0,0 +1,223 @@
+#include <raylib.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "definition.hpp"
+#include "settings.hpp"
+#include "app.hpp"
+#include "utilities/timeline.hpp"
+#include "utilities/midi_file.hpp"
+#include "utilities/wave_file.hpp"
+
+constexpr const SizeType MIDI_CHANNEL_COUNT = 16;
+constexpr const FloatType MIDI_A4_KEY = 69.0;
+constexpr const FloatType MIDI_A4_FREQUENCY = 440.0;
+constexpr const FloatType MIDI_BEND_RANGE = 2.0;
+constexpr const FloatType MIDI_FULL_AMPLITUDE = App<>::AVERAGE_AMPLITUDE * 2.0;
+// Rendered after the end of a MIDI file, so releases and resonances can ring out.
+constexpr const FloatType MIDI_TAIL_DURATION = 2.0;
+// Control steps ticked ahead of one timeline block; every step sends at most one event per key, so they always fit
+// in the event queue.
+constexpr const SizeType MAX_TIMELINE_BLOCK_STEP_COUNT = App<>::NoteEventQueueType::CAPACITY / App<>::KEY_COUNT;
+
+auto Report(const App<> &pApp, FloatType pDuration, std::chrono::steady_clock::time_point pStartTime) -> void
+{
+    const auto elapsed = std::chrono::duration<FloatType>(std::chrono::steady_clock::now() - pStartTime).count();
+    TraceLog(LOG_INFO, "Rendered %.2f s of audio in %.3f s (%.1fx real time).", pDuration, elapsed, pDuration / std::max(elapsed, 1e-9));
+
+    const auto &performance = pApp.ViewPerformance();
+    TraceLog(LOG_INFO, "DSP load: %.2f%% mean, %.2f%% peak over %zu blocks.",
+             performance.ComputeMeanLoad() * 100.0, performance.ComputePeakLoad() * 100.0, performance.ViewHistorySize());
+}
+
+// Writes the mixer's output format unchanged, so the file holds exactly what the device would have played.
+template <class TSampleType>
+auto RenderTimeline(const Timeline &pTimeline, const std::string &pPath, const Settings &pSettings) -> IntType
+{
+    auto file = WaveFile<TSampleType>(pPath, pSettings.sampleRate);
+    if (!file.IsOpen())
+    {
+        TraceLog(LOG_ERROR, "Could not open %s for writing.", pPath.c_str());
+        return 1;
+    }
+
+    auto app = App(pSettings);
+    auto block = std::vector<TSampleType>(pSettings.blockSize);
+    const auto sampleCount = SizeType(pTimeline.ViewDuration() * pSettings.sampleRate);
+    const auto startTime = std::chrono::steady_clock::now();
+    app.Start();
+
+    // Same fixed control step as the interactive build. Every step that starts within a block is ticked before the
+    // block and stamped with its first sample, so the block is rendered whole and split at those samples like MIDI
+    // events, and the performance figures are those of blockSize blocks.
+    auto step = SizeType(0);
+    const auto computeStepTime = [&pSettings](SizeType pStep)
+    { return pStep * pSettings.sampleRate / pSettings.controlRate; };
+    for (auto renderedSampleCount = SizeType(0); renderedSampleCount < sampleCount;)
+    {
+        auto blockEndSampleCount = std::min(sampleCount, renderedSampleCount + pSettings.blockSize);
+        for (auto stepCount = SizeType(0); stepCount < MAX_TIMELINE_BLOCK_STEP_COUNT && computeStepTime(step) < blockEndSampleCount; stepCount++, step++)
+        {
+            const auto &entry = pTimeline.ViewEntry(FloatType(step) / pSettings.controlRate);
+            app.Perform(entry.mouseSpeed, [&entry](KeyboardKey pKey)
+                        { return entry.IsKeyDown(pKey); });
+            app.Tick(computeStepTime(step));
+        }
+        // Cut short at the first step left unticked.
+        blockEndSampleCount = std::min(blockEndSampleCount, computeStepTime(step));
+
+        const auto blockSampleCount = blockEndSampleCount - renderedSampleCount;
+        app.Render(block.data(), blockSampleCount);
+        file.Write(block.data(), blockSampleCount);
+        renderedSampleCount = blockEndSampleCount;
+        app.CollectPerformance();
+    }
+
+    app.Finish();
+    file.Close();
+    Report(app, pTimeline.ViewDuration(), startTime);
+    return 0;
+}
+
+// MIDI notes play the keyboard note within App::NOTE_MATCH_CENTS of their pitch; other notes are skipped.
+// Velocity 1 plays at MIDI_FULL_AMPLITUDE, and a full pitch bend moves by MIDI_BEND_RANGE semitones.
+// Each keyboard note follows the bend of the channel that last started it.
+auto ConvertMidi(const MidiFile &pMidi, const Settings &pSettings) -> std::vector<App<>::NoteEventType>
+{
+    using NoteEventKind = App<>::NoteEventKind;
+    auto events = std::vector<App<>::NoteEventType>();
+    auto channelBends = std::array<FloatType, MIDI_CHANNEL_COUNT>();
+    channelBends.fill(1.0);
+    auto noteChannels = std::array<SizeType, App<>::KEY_COUNT>();
+    noteChannels.fill(MIDI_CHANNEL_COUNT);
+    auto noteBends = std::array<FloatType, App<>::KEY_COUNT>();
+    noteBends.fill(1.0);
+    auto skippedNoteCount = SizeType(0);
+
+    for (const auto &midiEvent : pMidi.ViewEvents())
+    {
+        const auto time = SizeType(std::llround(midiEvent.time * pSettings.sampleRate));
+        if (midiEvent.kind == MidiEventKind::PITCH_BEND)
+        {
+            channelBends[midiEvent.channel] = std::exp2(midiEvent.value * MIDI_BEND_RANGE / 12.0);
+            for (SizeType note = 0; note < App<>::KEY_COUNT; note++)
+                if (noteChannels[note] == midiEvent.channel && noteBends[note] != channelBends[midiEvent.channel])
+                {
+                    noteBends[note] = channelBends[midiEvent.channel];
+                    events.push_back({time, NoteEventKind::BEND, note, noteBends[note]});
+                }
+            continue;
+        }
+
+        const auto note = App<>::FindNote(MIDI_A4_FREQUENCY * std::exp2((FloatType(midiEvent.key) - MIDI_A4_KEY) / 12.0));
+        if (note == App<>::VoiceBankType::NO_NOTE)
+        {
+            skippedNoteCount += midiEvent.kind == MidiEventKind::NOTE_ON;
+            continue;
+        }
+        if (midiEvent.kind == MidiEventKind::NOTE_OFF)
+        {
+            if (noteChannels[note] == midiEvent.channel)
+                events.push_back({time, NoteEventKind::AMPLITUDE, note, 0.0});
+            continue;
+        }
+        noteChannels[note] = midiEvent.channel;
+        if (noteBends[note] != channelBends[midiEvent.channel])
+        {
+            noteBends[note] = channelBends[midiEvent.channel];
+            events.push_back({time, NoteEventKind::BEND, note, noteBends[note]});
+        }
+        events.push_back({time, NoteEventKind::AMPLITUDE, note, midiEvent.value * MIDI_FULL_AMPLITUDE});
+    }
+
+    if (skippedNoteCount > 0)
+        TraceLog(LOG_WARNING, "Skipped %zu notes outside the keyboard.", skippedNoteCount);
+    return events;
+}
+
+// Plays a MIDI file through the timestamped event queue, so every event lands on its exact sample whatever the block size.
+// Blocks are cut short only when the queue is full, so events are never applied late.
+template <class TSampleType>
+auto RenderMidi(const MidiFile &pMidi, const std::string &pPath, const Settings &pSettings) -> IntType
+{
+    auto file = WaveFile<TSampleType>(pPath, pSettings.sampleRate);
+    if (!file.IsOpen())
+    {
+        TraceLog(LOG_ERROR, "Could not open %s for writing.", pPath.c_str());
+        return 1;
+    }
+
+    const auto events = ConvertMidi(pMidi, pSettings);
+    auto app = App(pSettings);
+    auto block = std::vector<TSampleType>(pSettings.blockSize);
+    const auto duration = pMidi.ViewDuration() + MIDI_TAIL_DURATION;
+    const auto sampleCount = SizeType(duration * pSettings.sampleRate);
+    const auto startTime = std::chrono::steady_clock::now();
+    app.Start();
+
+    auto nextEvent = SizeType(0);
+    for (auto renderedSampleCount = SizeType(0); renderedSampleCount < sampleCount;)
+    {
+        auto blockEndSampleCount = std::min(sampleCount, renderedSampleCount + pSettings.blockSize);
+        while (nextEvent < events.size() && events[nextEvent].time < blockEndSampleCount && app.Schedule(events[nextEvent]))
+            nextEvent++;
+        if (nextEvent < events.size() && events[nextEvent].time < blockEndSampleCount)
+            blockEndSampleCount = std::max(events[nextEvent].time, renderedSampleCount + 1);
+
+        const auto blockSampleCount = blockEndSampleCount - renderedSampleCount;
+        app.Render(block.data(), blockSampleCount);
+        file.Write(block.data(), blockSampleCount);
+        renderedSampleCount = blockEndSampleCount;
+        app.CollectPerformance();
+    }
+
+    app.Finish();
+    file.Close();
+    Report(app, duration, startTime);
+    return 0;
+}
+
+// Renders a scripted performance, or a Standard MIDI File when the input ends in ".mid" or ".midi",
+// to a WAV (or .raw) file without a window or audio device.
+//
+//   gracile-render <timeline|score.mid> <output.wav> [--block-size <samples>] [--sample-rate <hertz>] [--control-rate <hertz>] [--workers <count>]
+//                  [--bit-depth <16|32>] [--dither <0|1>] [--unison <count>] [--unison-spread <cents>]
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        TraceLog(LOG_ERROR, "Usage: %s <timeline|score.mid> <output.wav> [--block-size <samples>] [--sample-rate <hertz>] [--control-rate <hertz>] [--workers <count>] [--bit-depth <16|32>] [--dither <0|1>] [--unison <count>] [--unison-spread <cents>]", argv[0]);
+        return 1;
+    }
+
+    const auto inputPath = std::string(argv[1]);
+    const auto isMidi = inputPath.ends_with(".mid") || inputPath.ends_with(".midi");
+    if (isMidi)
+    {
+        const auto midi = MidiFile::Load(inputPath);
+        if (!midi)
+        {
+            TraceLog(LOG_ERROR, "Could not read MIDI file %s.", argv[1]);
+            return 1;
+        }
+        const auto settings = ParseSettings(argc, argv, 3);
+        if (settings.outputBitDepth == 32)
+            return RenderMidi<App<>::MixerType::FloatSampleType>(*midi, argv[2], settings);
+        return RenderMidi<App<>::MixerType::PcmSampleType>(*midi, argv[2], settings);
+    }
+
+    const auto timeline = Timeline::Load(argv[1]);
+    if (!timeline)
+    {
+        TraceLog(LOG_ERROR, "Could not read timeline %s.", argv[1]);
+        return 1;
+    }
+
+    const auto settings = ParseSettings(argc, argv, 3);
+    if (settings.outputBitDepth == 32)
+        return RenderTimeline<App<>::MixerType::FloatSampleType>(*timeline, argv[2], settings);
+    return RenderTimeline<App<>::MixerType::PcmSampleType>(*timeline, argv[2], settings);
+}